@@ -6,7 +6,9 @@ echo "Compilando AudioEqualizer..."
 
 cd "$(dirname "$0")"
 
-g++ -std=c++17 -O2 -DNDEBUG -DUNICODE -D_UNICODE \
+# Win64 GCC no alinea la pila a más de 16 bytes: los registros AVX que se
+# guardan en ella tienen que moverse con instrucciones sin alineación
+g++ -std=c++17 -O2 -DNDEBUG -DUNICODE -D_UNICODE -Wa,-muse-unaligned-vector-move \
     -I../external/imgui -I../external/imgui/backends -I../src -I../external/miniaudio \
     ../src/main.cpp \
     ../src/audio/*.cpp \
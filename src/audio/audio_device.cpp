@@ -1,6 +1,56 @@
 #include "miniaudio.h"
 #include "audio_device.h"
 
+const char* audioBackendName(AudioBackend backend) {
+    switch (backend) {
+        case AudioBackend::Auto:       return "auto";
+        case AudioBackend::Wasapi:     return "wasapi";
+        case AudioBackend::PulseAudio: return "pulse";
+        case AudioBackend::Alsa:       return "alsa";
+        case AudioBackend::Null:       return "null";
+    }
+    return "unknown";
+}
+
+bool parseAudioBackend(const std::string& name, AudioBackend& backend) {
+    if (name == "auto")                                    backend = AudioBackend::Auto;
+    else if (name == "wasapi")                             backend = AudioBackend::Wasapi;
+    else if (name == "pulse" || name == "pulseaudio")      backend = AudioBackend::PulseAudio;
+    else if (name == "alsa")                               backend = AudioBackend::Alsa;
+    else if (name == "null")                               backend = AudioBackend::Null;
+    else return false;
+    return true;
+}
+
+bool audioBackendUsesLoopback(AudioBackend backend) {
+#ifdef _WIN32
+    return backend == AudioBackend::Auto || backend == AudioBackend::Wasapi;
+#else
+    return backend == AudioBackend::Wasapi;
+#endif
+}
+
+int AudioDeviceManager::initContext(ma_context* pContext, AudioBackend backend) {
+    ma_backend backends[2];
+    ma_uint32 count = 0;
+    switch (backend) {
+        case AudioBackend::Auto:
+#ifdef _WIN32
+            backends[count++] = ma_backend_wasapi;
+#else
+            backends[count++] = ma_backend_pulseaudio;
+            backends[count++] = ma_backend_alsa;
+#endif
+            break;
+        case AudioBackend::Wasapi:     backends[count++] = ma_backend_wasapi; break;
+        case AudioBackend::PulseAudio: backends[count++] = ma_backend_pulseaudio; break;
+        case AudioBackend::Alsa:       backends[count++] = ma_backend_alsa; break;
+        case AudioBackend::Null:       backends[count++] = ma_backend_null; break;
+    }
+    ma_context_config ctxCfg = ma_context_config_init();
+    return (int)ma_context_init(backends, count, &ctxCfg, pContext);
+}
+
 AudioDeviceManager::AudioDeviceManager() = default;
 
 AudioDeviceManager::~AudioDeviceManager() {
@@ -11,11 +61,9 @@ AudioDeviceManager::~AudioDeviceManager() {
     }
 }
 
-bool AudioDeviceManager::init() {
+bool AudioDeviceManager::init(AudioBackend backend) {
     pContext_ = new ma_context;
-    ma_backend backends[] = { ma_backend_wasapi };
-    ma_result res = ma_context_init(backends, 1, nullptr, pContext_);
-    if (res != MA_SUCCESS) {
+    if (initContext(pContext_, backend) != MA_SUCCESS) {
         delete pContext_;
         pContext_ = nullptr;
         return false;
@@ -23,15 +71,8 @@ bool AudioDeviceManager::init() {
     return true;
 }
 
-std::vector<AudioDeviceInfo> AudioDeviceManager::enumeratePlaybackDevices() {
+static std::vector<AudioDeviceInfo> toDeviceList(const ma_device_info* pDevices, ma_uint32 count) {
     std::vector<AudioDeviceInfo> result;
-    if (!pContext_) return result;
-
-    ma_device_info* pDevices = nullptr;
-    ma_uint32 count = 0;
-    if (ma_context_get_devices(pContext_, &pDevices, &count, nullptr, nullptr) != MA_SUCCESS)
-        return result;
-
     for (ma_uint32 i = 0; i < count; i++) {
         AudioDeviceInfo info;
         info.name = pDevices[i].name;
@@ -41,3 +82,23 @@ std::vector<AudioDeviceInfo> AudioDeviceManager::enumeratePlaybackDevices() {
     }
     return result;
 }
+
+std::vector<AudioDeviceInfo> AudioDeviceManager::enumeratePlaybackDevices() {
+    if (!pContext_) return {};
+
+    ma_device_info* pDevices = nullptr;
+    ma_uint32 count = 0;
+    if (ma_context_get_devices(pContext_, &pDevices, &count, nullptr, nullptr) != MA_SUCCESS)
+        return {};
+    return toDeviceList(pDevices, count);
+}
+
+std::vector<AudioDeviceInfo> AudioDeviceManager::enumerateCaptureDevices() {
+    if (!pContext_) return {};
+
+    ma_device_info* pDevices = nullptr;
+    ma_uint32 count = 0;
+    if (ma_context_get_devices(pContext_, nullptr, nullptr, &pDevices, &count) != MA_SUCCESS)
+        return {};
+    return toDeviceList(pDevices, count);
+}
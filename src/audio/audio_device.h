@@ -8,6 +8,21 @@ struct AudioDeviceInfo {
     bool isDefault = false;
 };
 
+// Auto resolves to WASAPI on Windows and PulseAudio, then ALSA, elsewhere.
+// Only WASAPI can capture what another device is playing (loopback); every
+// other backend records from a capture device instead.
+enum class AudioBackend {
+    Auto,
+    Wasapi,
+    PulseAudio,
+    Alsa,
+    Null
+};
+
+const char* audioBackendName(AudioBackend backend);
+bool parseAudioBackend(const std::string& name, AudioBackend& backend);
+bool audioBackendUsesLoopback(AudioBackend backend);
+
 struct ma_context;
 
 class AudioDeviceManager {
@@ -15,8 +30,13 @@ public:
     AudioDeviceManager();
     ~AudioDeviceManager();
 
-    bool init();
+    bool init(AudioBackend backend = AudioBackend::Auto);
     std::vector<AudioDeviceInfo> enumeratePlaybackDevices();
+    std::vector<AudioDeviceInfo> enumerateCaptureDevices();
+
+    // Shared with AudioEngine so both always talk to the same backend.
+    // Returns the miniaudio result code.
+    static int initContext(ma_context* pContext, AudioBackend backend);
 
 private:
     ma_context* pContext_ = nullptr;
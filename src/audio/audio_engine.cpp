@@ -5,7 +5,9 @@
 #include "miniaudio.h"
 
 #include "audio_engine.h"
+#include "dsp/cpu_dispatch.h"
 #include "dsp/dsp_common.h"
+#include "dsp/float_guard.h"
 #include <cmath>
 #include <cstring>
 #include <algorithm>
@@ -31,21 +33,14 @@ void AudioEngine::captureCallback(ma_device* pDevice, void* pOutput,
                                    const void* pInput, unsigned int frameCount) {
     AudioEngine* self = (AudioEngine*)pDevice->pUserData;
     if (!self || !pInput || frameCount == 0) return;
+    dsp::ScopedFlushDenormals noDenormals;
 
     const float* in = (const float*)pInput;
     int nCh = (int)pDevice->capture.channels;
     float sr = (float)pDevice->sampleRate;
-    size_t totalSamples = (size_t)frameCount * nCh;
 
-    float peakL = 0.0f, peakR = 0.0f;
-    for (unsigned int i = 0; i < frameCount; i += 32) {
-        float l = std::abs(in[i * nCh]);
-        if (l > peakL) peakL = l;
-        if (nCh > 1) {
-            float r = std::abs(in[i * nCh + 1]);
-            if (r > peakR) peakR = r;
-        }
-    }
+    float peakL, peakR;
+    dsp::kernels().peakLevels(in, (int)frameCount, nCh, peakL, peakR);
 
     const float decay = 0.98f;
     float currentInL = self->inputLevelL_.load(std::memory_order_relaxed);
@@ -55,40 +50,61 @@ void AudioEngine::captureCallback(ma_device* pDevice, void* pOutput,
     self->inputLevelL_.store(currentInL, std::memory_order_relaxed);
     self->inputLevelR_.store(currentInR, std::memory_order_relaxed);
 
-    float stackBuf[8192];
-    float* buf = stackBuf;
-    bool heap = false;
-    if (totalSamples > 8192) {
-        buf = new float[totalSamples];
-        heap = true;
-    }
-    std::memcpy(buf, in, totalSamples * sizeof(float));
-    self->dspChain_.process(buf, frameCount, nCh, sr);
-
-    float peakOutL = 0.0f, peakOutR = 0.0f;
-    for (unsigned int i = 0; i < frameCount; i += 32) {
-        float l = std::abs(buf[i * nCh]);
-        if (l > peakOutL) peakOutL = l;
-        if (nCh > 1) {
-            float r = std::abs(buf[i * nCh + 1]);
-            if (r > peakOutR) peakOutR = r;
-        }
+    self->debugFrameCount_.fetch_add(frameCount, std::memory_order_relaxed);
+
+    if (self->pullMode_) {
+        // Raw audio only; the playback callback processes it on demand
+        if (!self->ringBuffer_->write(in, (size_t)frameCount * nCh))
+            self->debugOverruns_.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
 
-    float currentOutL = self->outputLevelL_.load(std::memory_order_relaxed);
-    float currentOutR = self->outputLevelR_.load(std::memory_order_relaxed);
-    currentOutL = std::max(peakOutL, currentOutL * decay);
-    currentOutR = std::max(peakOutR, currentOutR * decay);
-    self->outputLevelL_.store(currentOutL, std::memory_order_relaxed);
-    self->outputLevelR_.store(currentOutR, std::memory_order_relaxed);
+    // Copy straight into the ring and run the chain there, so a block
+    // crosses memory once on its way in and once on its way out
+    size_t samples = (size_t)frameCount * nCh;
+    CircularBuffer<float>::Region region = self->ringBuffer_->reserveWrite(samples);
+    if (region.size() < samples) {
+        self->debugOverruns_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
 
-    self->ringBuffer_->write(buf, totalSamples);
-    if (heap) delete[] buf;
-    self->debugFrameCount_.fetch_add(frameCount, std::memory_order_relaxed);
+    if (region.firstCount % nCh == 0) {
+        self->processCaptureSpan(region.first, in, region.firstCount, nCh, sr);
+        if (region.secondCount)
+            self->processCaptureSpan(region.second, in + region.firstCount, region.secondCount, nCh, sr);
+    } else {
+        // The wrap splits a frame (the channel count does not divide the
+        // ring size): process in scratch, sized in start(), and copy over
+        float* buf = self->captureScratch_.data();
+        unsigned int chunkFrames = (unsigned int)(self->captureScratch_.size() / nCh);
+        size_t written = 0;
+        for (unsigned int offset = 0; offset < frameCount; offset += chunkFrames) {
+            unsigned int frames = std::min(chunkFrames, frameCount - offset);
+            size_t chunk = (size_t)frames * nCh;
+            std::memcpy(buf, in + (size_t)offset * nCh, chunk * sizeof(float));
+            self->dspChain_.process(buf, frames, nCh, sr);
+            self->updateOutputLevels(buf, frames, nCh);
+
+            for (size_t i = 0; i < chunk; i++, written++) {
+                float* dst = written < region.firstCount ? region.first + written
+                                                         : region.second + (written - region.firstCount);
+                *dst = buf[i];
+            }
+        }
+    }
+    self->ringBuffer_->commitWrite(samples);
+}
+
+void AudioEngine::processCaptureSpan(float* dst, const float* src, size_t samples, int nCh, float sr) {
+    unsigned int frames = (unsigned int)(samples / nCh);
+    std::memcpy(dst, src, samples * sizeof(float));
+    dspChain_.process(dst, (int)frames, nCh, sr);
+    updateOutputLevels(dst, frames, nCh);
 }
 
 void AudioEngine::playbackCallback(ma_device* pDevice, void* pOutput,
                                     const void* pInput, unsigned int frameCount) {
+    dsp::ScopedFlushDenormals noDenormals;
     AudioEngine* self = (AudioEngine*)pDevice->pUserData;
     float* out = (float*)pOutput;
     int nCh = (int)pDevice->playback.channels;
@@ -98,23 +114,117 @@ void AudioEngine::playbackCallback(ma_device* pDevice, void* pOutput,
         std::memset(out, 0, totalSamples * sizeof(float));
         return;
     }
+    if (self->pullMode_) {
+        self->pullAndProcess(out, frameCount, nCh, (float)pDevice->sampleRate);
+        return;
+    }
     if (!self->ringBuffer_->read(out, totalSamples)) {
         std::memset(out, 0, totalSamples * sizeof(float));
+        self->debugUnderruns_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
-bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
+void AudioEngine::pullAndProcess(float* out, unsigned int frameCount, int nCh, float sr) {
+    // The resampler is sized for one device period; anything longer is
+    // served in pieces
+    unsigned int maxFrames = (unsigned int)pullMaxFrames_;
+    while (frameCount > maxFrames) {
+        pullAndProcess(out, maxFrames, nCh, sr);
+        out += (size_t)maxFrames * nCh;
+        frameCount -= maxFrames;
+    }
+
+    size_t fill = ringBuffer_->readAvailable();
+
+    // Hold off until the FIFO has the target amount on top of this request,
+    // so that much stays buffered after every pull
+    if (!pullPrimed_) {
+        resampler_.reset();
+        size_t firstPull = (size_t)resampler_.getInputFramesNeeded((int)frameCount) * nCh;
+        if (fill < pullTargetSamples_ + firstPull) {
+            std::memset(out, 0, (size_t)frameCount * nCh * sizeof(float));
+            return;
+        }
+        pullPrimed_ = true;
+    }
+
+    int inputFrames = resampler_.getInputFramesNeeded((int)frameCount);
+    size_t needed = (size_t)inputFrames * nCh;
+
+    // Capture has run far ahead (e.g. after a stall here): drop the oldest
+    // audio so latency goes back to the target instead of staying high
+    if (fill > 2 * pullTargetSamples_ + needed) {
+        size_t excess = fill - (pullTargetSamples_ + needed);
+        excess -= excess % nCh;
+        ringBuffer_->discard(excess);
+        fill -= excess;
+        debugOverruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!ringBuffer_->read(resampler_.getInputBuffer(), needed)) {
+        std::memset(out, 0, (size_t)frameCount * nCh * sizeof(float));
+        pullPrimed_ = false;
+        debugUnderruns_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    resampler_.process(inputFrames, out, (int)frameCount);
+
+    // Steer the next pull by what is left queued
+    size_t remainingFrames = (fill - needed) / nCh;
+    resampler_.setRatio(driftController_.update((double)remainingFrames, (int)frameCount));
+    debugDriftPpm_.store((float)driftController_.getCorrectionPpm(), std::memory_order_relaxed);
+
+    dspChain_.process(out, (int)frameCount, nCh, sr);
+    updateOutputLevels(out, frameCount, nCh);
+
+    // Input-to-output delay of the audio just handed to the device: what sat
+    // ahead of it in the FIFO, the resampler and the device buffers, plus the
+    // chain's own
+    size_t queuedFrames = remainingFrames + VariableResampler::getLatencyFrames() +
+                          pullDeviceFrames_ + (size_t)dspChain_.getLatencySamples();
+    debugLatencyMs_.store((float)(queuedFrames * 1000.0 / sr), std::memory_order_relaxed);
+}
+
+void AudioEngine::updateOutputLevels(const float* buf, unsigned int frameCount, int nCh) {
+    float peakOutL, peakOutR;
+    dsp::kernels().peakLevels(buf, (int)frameCount, nCh, peakOutL, peakOutR);
+
+    const float decay = 0.98f;
+    float currentOutL = outputLevelL_.load(std::memory_order_relaxed);
+    float currentOutR = outputLevelR_.load(std::memory_order_relaxed);
+    currentOutL = std::max(peakOutL, currentOutL * decay);
+    currentOutR = std::max(peakOutR, currentOutR * decay);
+    outputLevelL_.store(currentOutL, std::memory_order_relaxed);
+    outputLevelR_.store(currentOutR, std::memory_order_relaxed);
+
+    // Input levels come from the capture callback, which in pull mode runs on
+    // another thread; they are only sampled here so the lock has one writer.
+    Telemetry telemetry;
+    telemetry.inputPeak[0] = inputLevelL_.load(std::memory_order_relaxed);
+    telemetry.inputPeak[1] = inputLevelR_.load(std::memory_order_relaxed);
+    telemetry.outputPeak[0] = currentOutL;
+    telemetry.outputPeak[1] = currentOutR;
+    dspChain_.fillTelemetry(telemetry);
+    telemetry_.store(telemetry);
+}
+
+bool AudioEngine::start(int captureIdx, int playbackIdx) {
     if (running_.load()) return false;
     status_.store(Status::Starting);
     errorDetail_.clear();
     debugFrameCount_.store(0);
+    debugUnderruns_.store(0);
+    debugOverruns_.store(0);
+    debugLatencyMs_.store(0.0f);
+    debugDriftPpm_.store(0.0f);
+    pullMode_ = params_.pullMode.load(std::memory_order_relaxed);
+    pullPrimed_ = false;
 
     pContext_ = new ma_context;
-    ma_backend backends[] = { ma_backend_wasapi };
-    ma_context_config ctxCfg = ma_context_config_init();
-    ma_result res = ma_context_init(backends, 1, &ctxCfg, pContext_);
+    ma_result res = (ma_result)AudioDeviceManager::initContext(pContext_, backend_);
     if (res != MA_SUCCESS) {
-        errorDetail_ = "WASAPI context init (code " + std::to_string((int)res) + ")";
+        errorDetail_ = std::string("Context init, backend ") + audioBackendName(backend_) +
+                       " (code " + std::to_string((int)res) + ")";
         delete pContext_; pContext_ = nullptr;
         status_.store(Status::ErrorInit);
         return false;
@@ -129,16 +239,27 @@ bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
 
     ringBuffer_ = std::make_unique<CircularBuffer<float>>(48000 * 2 * 2);
 
-    ma_device_config capCfg = ma_device_config_init(ma_device_type_loopback);
-    if (loopbackIdx >= 0 && loopbackIdx < (int)playbackCount) {
-        capCfg.playback.pDeviceID = &pPlaybackDevices[loopbackIdx].id;
+    // All DSP memory is laid out before any device callback can run
+    int blockSize = params_.blockSize.load(std::memory_order_relaxed);
+    captureScratch_.assign((size_t)std::max(blockSize, 8192) * 2, 0.0f);
+    dspChain_.prepare(48000.0f, blockSize, 2);
+
+    bool loopback = audioBackendUsesLoopback(backend_);
+    ma_device_config capCfg = ma_device_config_init(loopback ? ma_device_type_loopback
+                                                             : ma_device_type_capture);
+    if (loopback) {
+        if (captureIdx >= 0 && captureIdx < (int)playbackCount)
+            capCfg.playback.pDeviceID = &pPlaybackDevices[captureIdx].id;
+    } else {
+        if (captureIdx >= 0 && captureIdx < (int)captureCount)
+            capCfg.capture.pDeviceID = &pCaptureDevices[captureIdx].id;
     }
     capCfg.capture.format     = ma_format_f32;
     capCfg.capture.channels   = 2;
     capCfg.playback.format    = ma_format_f32;
     capCfg.playback.channels  = 2;
     capCfg.sampleRate         = 48000;
-    capCfg.periodSizeInFrames = params_.blockSize.load(std::memory_order_relaxed);
+    capCfg.periodSizeInFrames = blockSize;
     capCfg.dataCallback       = &AudioEngine::captureCallback;
     capCfg.pUserData          = this;
     capCfg.performanceProfile = ma_performance_profile_low_latency;
@@ -146,7 +267,7 @@ bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
     pCaptureDevice_ = new ma_device;
     res = ma_device_init(pContext_, &capCfg, pCaptureDevice_);
     if (res != MA_SUCCESS) {
-        errorDetail_ = "Loopback init (code " + std::to_string((int)res) + ")";
+        errorDetail_ = std::string(loopback ? "Loopback" : "Capture") + " init (code " + std::to_string((int)res) + ")";
         delete pCaptureDevice_; pCaptureDevice_ = nullptr;
         ma_context_uninit(pContext_); delete pContext_; pContext_ = nullptr;
         ringBuffer_.reset();
@@ -161,7 +282,7 @@ bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
     playCfg.playback.format     = ma_format_f32;
     playCfg.playback.channels   = 2;
     playCfg.sampleRate          = 48000;
-    playCfg.periodSizeInFrames  = params_.blockSize.load(std::memory_order_relaxed);
+    playCfg.periodSizeInFrames  = blockSize;
     playCfg.dataCallback        = &AudioEngine::playbackCallback;
     playCfg.pUserData           = this;
     playCfg.performanceProfile  = ma_performance_profile_low_latency;
@@ -179,8 +300,44 @@ bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
         return false;
     }
 
+    ma_uint32 captureChannels = pCaptureDevice_->capture.channels;
+    ma_uint32 playbackChannels = pPlaybackDevice_->playback.channels;
+    if (pullMode_ && (pCaptureDevice_->sampleRate != pPlaybackDevice_->sampleRate ||
+                      captureChannels != playbackChannels)) {
+        errorDetail_ = "Pull mode needs matching capture/playback formats";
+        ma_device_uninit(pCaptureDevice_);
+        ma_device_uninit(pPlaybackDevice_);
+        delete pCaptureDevice_; pCaptureDevice_ = nullptr;
+        delete pPlaybackDevice_; pPlaybackDevice_ = nullptr;
+        ma_context_uninit(pContext_); delete pContext_; pContext_ = nullptr;
+        ringBuffer_.reset();
+        status_.store(Status::ErrorFormat);
+        return false;
+    }
+
+    if (pCaptureDevice_->sampleRate != 48000 || captureChannels != 2) {
+        dspChain_.prepare((float)pCaptureDevice_->sampleRate, blockSize, (int)captureChannels);
+        captureScratch_.assign((size_t)std::max(blockSize, 8192) * captureChannels, 0.0f);
+    }
+
+    if (pullMode_) {
+        float targetMs = params_.targetLatencyMs.load(std::memory_order_relaxed);
+        pullTargetSamples_ = (size_t)(targetMs * 0.001f * pPlaybackDevice_->sampleRate) * playbackChannels;
+        pullDeviceFrames_ = (size_t)pPlaybackDevice_->playback.internalPeriodSizeInFrames *
+                            pPlaybackDevice_->playback.internalPeriods;
+        // Room for the target, a burst from each device, and the overrun margin
+        size_t periods = (size_t)pCaptureDevice_->capture.internalPeriodSizeInFrames +
+                         pPlaybackDevice_->playback.internalPeriodSizeInFrames;
+        size_t capacity = 2 * pullTargetSamples_ + 4 * std::max<size_t>(periods, (size_t)blockSize) * playbackChannels;
+        ringBuffer_ = std::make_unique<CircularBuffer<float>>(std::max<size_t>(capacity, (size_t)48000 * 2 * 2));
+
+        pullMaxFrames_ = std::max<int>(blockSize, (int)pPlaybackDevice_->playback.internalPeriodSizeInFrames);
+        resampler_.prepare((int)playbackChannels, pullMaxFrames_, DriftController::MAX_CORRECTION_PPM * 1e-6);
+        driftController_.reset(pullTargetSamples_ / (double)playbackChannels, pPlaybackDevice_->sampleRate);
+    }
+
     debugSampleRate_.store((int)pCaptureDevice_->sampleRate);
-    debugChannels_.store((int)pCaptureDevice_->capture.channels);
+    debugChannels_.store((int)captureChannels);
 
     res = ma_device_start(pPlaybackDevice_);
     if (res != MA_SUCCESS) {
@@ -197,7 +354,7 @@ bool AudioEngine::start(int loopbackIdx, int playbackIdx) {
 
     res = ma_device_start(pCaptureDevice_);
     if (res != MA_SUCCESS) {
-        errorDetail_ = "Loopback start (code " + std::to_string((int)res) + ")";
+        errorDetail_ = std::string(loopback ? "Loopback" : "Capture") + " start (code " + std::to_string((int)res) + ")";
         ma_device_stop(pPlaybackDevice_);
         ma_device_uninit(pCaptureDevice_);
         ma_device_uninit(pPlaybackDevice_);
@@ -238,6 +395,7 @@ void AudioEngine::stop() {
     ringBuffer_.reset();
     inputLevelL_.store(0); inputLevelR_.store(0);
     outputLevelL_.store(0); outputLevelR_.store(0);
+    telemetry_.store(Telemetry{});
     running_.store(false);
     status_.store(Status::Stopped);
 }
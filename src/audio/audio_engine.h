@@ -3,9 +3,15 @@
 #include <atomic>
 #include <string>
 #include <memory>
+#include <vector>
 #include "dsp/dsp_chain.h"
 #include "common/params.h"
-#include "circular_buffer.h"
+#include "common/circular_buffer.h"
+#include "common/seqlock.h"
+#include "common/telemetry.h"
+#include "audio_device.h"
+#include "drift_controller.h"
+#include "dsp/variable_resampler.h"
 
 struct ma_device;
 struct ma_context;
@@ -24,36 +30,67 @@ public:
     AudioEngine(DSPChain& dspChain, SharedParams& params);
     ~AudioEngine();
 
-    bool start(int loopbackIdx, int playbackIdx);
+    // Takes effect at the next start(). With a loopback backend the capture
+    // index selects a playback device to record from, otherwise a capture
+    // device.
+    void setBackend(AudioBackend backend) { backend_ = backend; }
+    AudioBackend getBackend() const { return backend_; }
+
+    bool start(int captureIdx, int playbackIdx);
     void stop();
     bool isRunning() const { return running_.load(std::memory_order_relaxed); }
 
     Status getStatus() const { return status_.load(std::memory_order_relaxed); }
     const std::string& getErrorDetail() const { return errorDetail_; }
 
-    float getInputLevelL()  const { return inputLevelL_.load(std::memory_order_relaxed); }
-    float getInputLevelR()  const { return inputLevelR_.load(std::memory_order_relaxed); }
-    float getOutputLevelL() const { return outputLevelL_.load(std::memory_order_relaxed); }
-    float getOutputLevelR() const { return outputLevelR_.load(std::memory_order_relaxed); }
-    float getGainReduction() const { return dspChain_.getCompressor().getGainReduction(); }
+    // Meters as of the last processed block; safe from any thread
+    Telemetry getTelemetry() const { return telemetry_.load(); }
 
     int getDebugSampleRate() const { return debugSampleRate_.load(std::memory_order_relaxed); }
     int getDebugChannels() const { return debugChannels_.load(std::memory_order_relaxed); }
     uint64_t getDebugFrameCount() const { return debugFrameCount_.load(std::memory_order_relaxed); }
+    // Blocks the FIFO could not supply (underruns) or had to drop (overruns)
+    uint32_t getDebugUnderruns() const { return debugUnderruns_.load(std::memory_order_relaxed); }
+    uint32_t getDebugOverruns() const { return debugOverruns_.load(std::memory_order_relaxed); }
+    // Pull mode only: capture-to-output delay of the latest block, 0 otherwise
+    float getDebugLatencyMs() const { return debugLatencyMs_.load(std::memory_order_relaxed); }
+    // Pull mode only: playback-side resampling correction for clock drift
+    float getDebugDriftPpm() const { return debugDriftPpm_.load(std::memory_order_relaxed); }
+    bool isPullMode() const { return pullMode_; }
+    StageProfiler::Stats getDebugStageStats(int stage) const { return dspChain_.getProfiler().getStats(stage); }
+    void resetDebugStageStats() { dspChain_.getProfiler().reset(); }
 
     static const char* statusToString(Status s);
 
 private:
     static void captureCallback(ma_device* pDevice, void* pOutput, const void* pInput, unsigned int frameCount);
     static void playbackCallback(ma_device* pDevice, void* pOutput, const void* pInput, unsigned int frameCount);
+    void processCaptureSpan(float* dst, const float* src, size_t samples, int nCh, float sampleRate);
+    void pullAndProcess(float* out, unsigned int frameCount, int nCh, float sampleRate);
+    // Also publishes the telemetry, since it runs after every chain pass
+    void updateOutputLevels(const float* buf, unsigned int frameCount, int nCh);
 
     DSPChain& dspChain_;
     SharedParams& params_;
 
+    AudioBackend backend_ = AudioBackend::Auto;
     ma_context* pContext_ = nullptr;
     ma_device* pCaptureDevice_ = nullptr;
     ma_device* pPlaybackDevice_ = nullptr;
     std::unique_ptr<CircularBuffer<float>> ringBuffer_;
+    std::vector<float> captureScratch_;   // only when a frame straddles the ring's wrap
+
+    // Pull mode: capture only queues raw audio; the playback callback pulls
+    // what it needs and runs the chain, keeping pullTargetSamples_ queued.
+    // The pull goes through a resampler steered by the FIFO fill, which
+    // absorbs the drift between the two device clocks.
+    bool pullMode_ = false;
+    bool pullPrimed_ = false;
+    size_t pullTargetSamples_ = 0;
+    size_t pullDeviceFrames_ = 0;
+    int pullMaxFrames_ = 0;
+    VariableResampler resampler_;
+    DriftController driftController_;
 
     std::atomic<bool> running_{false};
     std::atomic<Status> status_{Status::Stopped};
@@ -62,10 +99,15 @@ private:
     std::atomic<float> inputLevelR_{0.0f};
     std::atomic<float> outputLevelL_{0.0f};
     std::atomic<float> outputLevelR_{0.0f};
+    SeqLock<Telemetry> telemetry_;
 
     std::atomic<int> debugSampleRate_{0};
     std::atomic<int> debugChannels_{0};
     std::atomic<uint64_t> debugFrameCount_{0};
+    std::atomic<uint32_t> debugUnderruns_{0};
+    std::atomic<uint32_t> debugOverruns_{0};
+    std::atomic<float> debugLatencyMs_{0.0f};
+    std::atomic<float> debugDriftPpm_{0.0f};
 
     std::string errorDetail_;
 };
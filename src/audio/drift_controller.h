@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+
+// PI loop turning the pull FIFO's fill level into a resampling ratio. The
+// capture and playback devices run on separate clocks; consuming slightly
+// faster or slower than 1:1 keeps the FIFO at its target instead of letting
+// it drain into underruns or grow until blocks are dropped.
+class DriftController {
+public:
+    // Largest correction, in parts per million of the sample rate. Real
+    // device pairs are within a few hundred ppm; the rest is headroom for
+    // pulling the fill back after a glitch.
+    static constexpr double MAX_CORRECTION_PPM = 2000.0;
+
+    void reset(double targetFrames, double sampleRate) {
+        targetFrames_ = targetFrames;
+        sampleRate_ = sampleRate;
+        averageFill_ = targetFrames;
+        integral_ = 0.0;
+        ratio_ = 1.0;
+    }
+
+    // Audio thread, once per pull: fillFrames is what remains queued after
+    // the pull, elapsedFrames the output frames since the last update.
+    // Returns input frames to consume per output frame.
+    double update(double fillFrames, int elapsedFrames) {
+        double dt = elapsedFrames / sampleRate_;
+
+        // Capture arrives in device-period bursts; average them out
+        double alpha = std::min(1.0, dt / AVERAGE_SECONDS);
+        averageFill_ += alpha * (fillFrames - averageFill_);
+        double errorSec = (averageFill_ - targetFrames_) / sampleRate_;
+
+        const double maxCorrection = MAX_CORRECTION_PPM * 1e-6;
+        integral_ += errorSec * dt;
+        integral_ = std::max(-maxCorrection / KI, std::min(integral_, maxCorrection / KI));
+
+        double correction = KP * errorSec + KI * integral_;
+        ratio_ = 1.0 + std::max(-maxCorrection, std::min(correction, maxCorrection));
+        return ratio_;
+    }
+
+    double getRatio() const { return ratio_; }
+    double getCorrectionPpm() const { return (ratio_ - 1.0) * 1e6; }
+
+private:
+    // Proportional gain in ratio per second of fill error: 10 ms off target
+    // corrects by 1000 ppm, settling in about ten seconds. The integral term
+    // learns the steady drift over roughly half a minute.
+    static constexpr double KP = 0.1;
+    static constexpr double KI = KP / 30.0;
+    static constexpr double AVERAGE_SECONDS = 0.5;
+
+    double targetFrames_ = 0.0;
+    double sampleRate_ = 48000.0;
+    double averageFill_ = 0.0;
+    double integral_ = 0.0;
+    double ratio_ = 1.0;
+};
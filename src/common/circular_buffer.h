@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+// Single-producer / single-consumer ring. Besides copying write()/read(),
+// either side can work directly in ring memory: reserveWrite()/commitWrite()
+// on the producer, peekRead()/consumeRead() on the consumer. Each index sits
+// on its own cache line together with the owner's cached copy of the other
+// side's index, which is only reloaded when the cached value says the ring
+// is full (or empty).
+template<typename T>
+class CircularBuffer {
+public:
+    // A run of ring memory split at the wrap point into at most two parts
+    struct Region {
+        T* first = nullptr;
+        size_t firstCount = 0;
+        T* second = nullptr;
+        size_t secondCount = 0;
+
+        size_t size() const { return firstCount + secondCount; }
+    };
+
+    explicit CircularBuffer(size_t capacity) {
+        capacity_ = 1;
+        while (capacity_ < capacity) capacity_ <<= 1;
+        buffer_.resize(capacity_);
+    }
+
+    // Producer: up to count free slots starting at the write position. Fill
+    // them, then commitWrite() how many are ready.
+    Region reserveWrite(size_t count) {
+        size_t w = producer_.pos.load(std::memory_order_relaxed);
+        if (capacity_ - (w - producer_.cachedOther) < count)
+            producer_.cachedOther = consumer_.pos.load(std::memory_order_acquire);
+        size_t free = capacity_ - (w - producer_.cachedOther);
+        return regionAt(w, std::min(count, free));
+    }
+
+    void commitWrite(size_t count) {
+        size_t w = producer_.pos.load(std::memory_order_relaxed);
+        producer_.pos.store(w + count, std::memory_order_release);
+    }
+
+    // Consumer: up to count readable items starting at the read position.
+    // They stay in the ring until consumeRead().
+    Region peekRead(size_t count) {
+        size_t r = consumer_.pos.load(std::memory_order_relaxed);
+        if (consumer_.cachedOther - r < count)
+            consumer_.cachedOther = producer_.pos.load(std::memory_order_acquire);
+        size_t available = consumer_.cachedOther - r;
+        return regionAt(r, std::min(count, available));
+    }
+
+    void consumeRead(size_t count) {
+        size_t r = consumer_.pos.load(std::memory_order_relaxed);
+        consumer_.pos.store(r + count, std::memory_order_release);
+    }
+
+    // All-or-nothing copying forms of the above
+    bool write(const T* data, size_t count) {
+        Region region = reserveWrite(count);
+        if (region.size() < count) return false;
+        std::memcpy(region.first, data, region.firstCount * sizeof(T));
+        if (region.secondCount)
+            std::memcpy(region.second, data + region.firstCount, region.secondCount * sizeof(T));
+        commitWrite(count);
+        return true;
+    }
+
+    bool read(T* data, size_t count) {
+        Region region = peekRead(count);
+        if (region.size() < count) return false;
+        std::memcpy(data, region.first, region.firstCount * sizeof(T));
+        if (region.secondCount)
+            std::memcpy(data + region.firstCount, region.second, region.secondCount * sizeof(T));
+        consumeRead(count);
+        return true;
+    }
+
+    // Consumer side: drops up to count of the oldest items, returns how many.
+    size_t discard(size_t count) {
+        count = peekRead(count).size();
+        consumeRead(count);
+        return count;
+    }
+
+    // Consumer side
+    size_t readAvailable() const {
+        size_t w = producer_.pos.load(std::memory_order_acquire);
+        size_t r = consumer_.pos.load(std::memory_order_relaxed);
+        return w - r;
+    }
+
+    // Producer side
+    size_t writeAvailable() const {
+        size_t w = producer_.pos.load(std::memory_order_relaxed);
+        size_t r = consumer_.pos.load(std::memory_order_acquire);
+        return capacity_ - (w - r);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    void reset() {
+        producer_.pos.store(0, std::memory_order_relaxed);
+        producer_.cachedOther = 0;
+        consumer_.pos.store(0, std::memory_order_relaxed);
+        consumer_.cachedOther = 0;
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) Side {
+        std::atomic<size_t> pos{0};
+        size_t cachedOther = 0;
+    };
+
+    Region regionAt(size_t pos, size_t count) {
+        Region region;
+        size_t masked = pos & (capacity_ - 1);
+        region.first = &buffer_[masked];
+        region.firstCount = std::min(count, capacity_ - masked);
+        region.secondCount = count - region.firstCount;
+        region.second = region.secondCount ? &buffer_[0] : nullptr;
+        return region;
+    }
+
+    Side producer_;
+    Side consumer_;
+    std::vector<T> buffer_;
+    size_t capacity_;
+};
@@ -44,6 +44,7 @@ struct ToneConfig {
 
 struct ReverbConfig {
     bool enabled = true;
+    int algorithm = 0;
     float decayTime = 0.9f;
     float hiRatio = 0.7f;
     float diffusion = 0.9f;
@@ -90,11 +91,14 @@ struct MultibandConfig {
     float subBassBoost = 10.0f;
     float subBassLowFreq = 30.0f;
     float subBassHighFreq = 250.0f;
+    bool multirate = false;
     bool loaded = false;
 };
 
 struct AudioConfig {
     int blockSize = 1024;
+    bool pullMode = false;
+    float targetLatencyMs = 20.0f;
     bool loaded = false;
 };
 
@@ -107,6 +111,7 @@ struct DeviceConfig {
 struct EQConfig {
     std::string name;
     float preamp = 0.0f;
+    bool linearPhase = false;
     std::vector<ConfigBand> bands;
 };
 
@@ -218,6 +223,8 @@ inline AppConfig loadConfig(const std::string& path) {
         }
     }
 
+    cfg.eq.linearPhase = extractBoolValue(content, "linearPhase", false);
+
     size_t bandsStart = content.find("\"bands\"");
     if (bandsStart != std::string::npos) {
         bandsStart = content.find('[', bandsStart);
@@ -290,6 +297,8 @@ inline AppConfig loadConfig(const std::string& path) {
     if (!revObj.empty()) {
         cfg.reverb.loaded = true;
         cfg.reverb.enabled = extractBoolValue(revObj, "enabled", true);
+        if (revObj.find("\"algorithm\"") != std::string::npos)
+            cfg.reverb.algorithm = extractIntValue(revObj, "algorithm");
         if (revObj.find("\"decayTime\"") != std::string::npos)
             cfg.reverb.decayTime = extractFloatValue(revObj, "decayTime");
         if (revObj.find("\"hiRatio\"") != std::string::npos)
@@ -397,6 +406,7 @@ inline AppConfig loadConfig(const std::string& path) {
             cfg.multiband.subBassLowFreq = extractFloatValue(mbObj, "subBassLowFreq");
         if (mbObj.find("\"subBassHighFreq\"") != std::string::npos)
             cfg.multiband.subBassHighFreq = extractFloatValue(mbObj, "subBassHighFreq");
+        cfg.multiband.multirate = extractBoolValue(mbObj, "multirate", false);
     }
 
     std::string devObj = extractObject(content, "devices");
@@ -412,6 +422,11 @@ inline AppConfig loadConfig(const std::string& path) {
         cfg.audio.blockSize = extractIntValue(audioObj, "blockSize");
         if (cfg.audio.blockSize < 64) cfg.audio.blockSize = 64;
         if (cfg.audio.blockSize > 16384) cfg.audio.blockSize = 16384;
+        cfg.audio.pullMode = extractBoolValue(audioObj, "pullMode", false);
+        if (audioObj.find("\"targetLatencyMs\"") != std::string::npos)
+            cfg.audio.targetLatencyMs = extractFloatValue(audioObj, "targetLatencyMs");
+        if (cfg.audio.targetLatencyMs < 1.0f) cfg.audio.targetLatencyMs = 1.0f;
+        if (cfg.audio.targetLatencyMs > 500.0f) cfg.audio.targetLatencyMs = 500.0f;
     }
 
     return cfg;
@@ -435,6 +450,7 @@ inline bool saveConfig(const std::string& path, const AppConfig& cfg) {
     file << "\t\"name\": \"" << jsonEscape(cfg.eq.name) << "\",\n";
     file << "\t\"preamp\": " << cfg.eq.preamp << ",\n";
     file << "\t\"parametric\": true,\n";
+    file << "\t\"linearPhase\": " << (cfg.eq.linearPhase ? "true" : "false") << ",\n";
 
     file << "\t\"bands\": [\n";
     for (size_t i = 0; i < cfg.eq.bands.size(); i++) {
@@ -469,6 +485,7 @@ inline bool saveConfig(const std::string& path, const AppConfig& cfg) {
 
     file << "\t\"reverb\": {\n";
     file << "\t\t\"enabled\": " << (cfg.reverb.enabled ? "true" : "false") << ",\n";
+    file << "\t\t\"algorithm\": " << cfg.reverb.algorithm << ",\n";
     file << "\t\t\"decayTime\": " << cfg.reverb.decayTime << ",\n";
     file << "\t\t\"hiRatio\": " << cfg.reverb.hiRatio << ",\n";
     file << "\t\t\"diffusion\": " << cfg.reverb.diffusion << ",\n";
@@ -522,6 +539,7 @@ inline bool saveConfig(const std::string& path, const AppConfig& cfg) {
     file << "\t\t\"enabled\": " << (cfg.multiband.enabled ? "true" : "false") << ",\n";
     file << "\t\t\"autoBalance\": " << (cfg.multiband.autoBalance ? "true" : "false") << ",\n";
     file << "\t\t\"autoBalanceSpeed\": " << cfg.multiband.autoBalanceSpeed << ",\n";
+    file << "\t\t\"multirate\": " << (cfg.multiband.multirate ? "true" : "false") << ",\n";
     file << "\t\t\"compression\": " << cfg.multiband.compression << ",\n";
     file << "\t\t\"outputGain\": " << cfg.multiband.outputGain << ",\n";
     file << "\t\t\"exciterAmount\": " << cfg.multiband.exciterAmount << ",\n";
@@ -536,7 +554,9 @@ inline bool saveConfig(const std::string& path, const AppConfig& cfg) {
     file << "\t},\n";
 
     file << "\t\"audio\": {\n";
-    file << "\t\t\"blockSize\": " << cfg.audio.blockSize << "\n";
+    file << "\t\t\"blockSize\": " << cfg.audio.blockSize << ",\n";
+    file << "\t\t\"pullMode\": " << (cfg.audio.pullMode ? "true" : "false") << ",\n";
+    file << "\t\t\"targetLatencyMs\": " << cfg.audio.targetLatencyMs << "\n";
     file << "\t}\n";
 
     file << "}\n";
@@ -1,9 +1,12 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include "config_loader.h"
+#include "triple_buffer.h"
 #include "dsp/reverb.h"
 #include "dsp/crossover.h"
 #include "dsp/band_limiter.h"
@@ -23,22 +26,40 @@ struct CompressorParams {
     std::atomic<bool>  enabled{true};
 };
 
+struct CompressorSettings {
+    float volume = 1.0f;
+    float attackMs = 10.0f;
+    float releaseMs = 100.0f;
+    float ratio = 4.0f;
+    float thresholdDb = -20.0f;
+    float makeupGainDb = 0.0f;
+    float sidechainFreqHz = 0.0f;
+    float preGainDb = 12.2f;
+    float kneeDb = 0.0f;
+    float expansionRatio = 1.0f;
+    float gateThresholdDb = -90.0f;
+    bool  enabled = true;
+    uint32_t version = 0;
+};
+
+static constexpr int MAX_EQ_BANDS = 64;
+
+// Every field is live-editable from the control side; publish() gathers
+// them into the snapshot like any other parameter.
 struct BandParam {
-    int type = 3;
-    float freq = 1000.0f;
-    float q = 1.0f;
+    std::atomic<int>   type{3};
+    std::atomic<float> freq{1000.0f};
+    std::atomic<float> q{1.0f};
     std::atomic<float> gainDb{0.0f};
 
     BandParam() = default;
     BandParam(int t, float f, float qv, float g)
         : type(t), freq(f), q(qv), gainDb(g) {}
-    BandParam(const BandParam& o)
-        : type(o.type), freq(o.freq), q(o.q),
-          gainDb(o.gainDb.load(std::memory_order_relaxed)) {}
+    BandParam(const BandParam& o) { *this = o; }
     BandParam& operator=(const BandParam& o) {
-        type = o.type;
-        freq = o.freq;
-        q = o.q;
+        type.store(o.type.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        freq.store(o.freq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        q.store(o.q.load(std::memory_order_relaxed), std::memory_order_relaxed);
         gainDb.store(o.gainDb.load(std::memory_order_relaxed), std::memory_order_relaxed);
         return *this;
     }
@@ -47,14 +68,19 @@ struct BandParam {
 struct EQParams {
     std::string configName;
     std::atomic<float> preamp{0.0f};
+    // Only resized on the control thread, between publish() calls. The audio
+    // thread never reads it: adding or removing bands reaches the chain as
+    // one published snapshot with a new band count, swapped in whole.
     std::vector<BandParam> bands;
     std::atomic<bool> enabled{true};
+    std::atomic<bool> linearPhase{false};
 
     int numBands() const { return (int)bands.size(); }
 
     void initFromConfig(const EQConfig& cfg) {
         configName = cfg.name;
         preamp.store(cfg.preamp, std::memory_order_relaxed);
+        linearPhase.store(cfg.linearPhase, std::memory_order_relaxed);
         bands.clear();
         bands.reserve(cfg.bands.size());
         for (const auto& cb : cfg.bands) {
@@ -63,6 +89,22 @@ struct EQParams {
     }
 };
 
+struct EQBandSettings {
+    int type = 3;
+    float freq = 1000.0f;
+    float q = 1.0f;
+    float gainDb = 0.0f;
+};
+
+struct EQSettings {
+    bool  enabled = true;
+    bool  linearPhase = false;
+    float preamp = 0.0f;
+    int   numBands = 0;
+    EQBandSettings bands[MAX_EQ_BANDS];
+    uint32_t version = 0;
+};
+
 struct ToneParams {
     std::atomic<float> bassFreq{70.0f};
     std::atomic<float> bassQ{0.10f};
@@ -75,6 +117,18 @@ struct ToneParams {
     std::atomic<bool>  trebleEnabled{true};
 };
 
+struct ToneSettings {
+    float bassFreq = 70.0f;
+    float bassQ = 0.10f;
+    float bassGainDb = 20.0f;
+    bool  bassEnabled = true;
+    float trebleFreq = 10000.0f;
+    float trebleQ = 0.60f;
+    float trebleGainDb = 20.0f;
+    bool  trebleEnabled = true;
+    uint32_t version = 0;
+};
+
 struct MultibandParams {
     std::atomic<bool> enabled{false};
     std::atomic<bool> autoBalance{true};
@@ -85,6 +139,35 @@ struct MultibandParams {
     std::atomic<float> subBassBoost{10.0f};
     std::atomic<float> subBassLowFreq{30.0f};
     std::atomic<float> subBassHighFreq{250.0f};
+    std::atomic<bool> multirate{false};
+};
+
+struct MultibandSettings {
+    bool  enabled = false;
+    bool  autoBalance = true;
+    float autoBalanceSpeed = 0.1f;
+    float compression = 0.5f;
+    float outputGain = 0.0f;
+    float exciterAmount = 0.3f;
+    float subBassBoost = 10.0f;
+    float subBassLowFreq = 30.0f;
+    float subBassHighFreq = 250.0f;
+    bool  multirate = false;
+    uint32_t version = 0;
+};
+
+// Plain copy of every section the audio thread consumes. Each section carries
+// a version that only changes when one of its values did, so stages can skip
+// coefficient work entirely while nothing is being edited.
+struct ParamSnapshot {
+    CompressorSettings compressor;
+    EQSettings eq;
+    ToneSettings tone;
+    ReverbSettings reverb;
+    CrossoverSettings crossover;
+    BandLimiterSettings bandLimiter;
+    MultibandSettings multiband;
+    bool bypassAll = false;
 };
 
 struct SharedParams {
@@ -99,6 +182,10 @@ struct SharedParams {
     std::atomic<int>  outputDeviceIndex{0};
     std::atomic<bool> deviceChangeRequested{false};
     std::atomic<int>  blockSize{1024};
+    // Pull mode runs the chain in the playback callback on raw captured audio
+    // held at targetLatencyMs of buffering. Both take effect at the next start.
+    std::atomic<bool>  pullMode{false};
+    std::atomic<float> targetLatencyMs{20.0f};
 
     void loadFromConfig(const AppConfig& cfg) {
         // EQ
@@ -147,6 +234,7 @@ struct SharedParams {
         // Reverb
         if (cfg.reverb.loaded) {
             reverb.enabled.store(cfg.reverb.enabled, std::memory_order_relaxed);
+            reverb.algorithm.store(cfg.reverb.algorithm, std::memory_order_relaxed);
             reverb.decayTime.store(cfg.reverb.decayTime, std::memory_order_relaxed);
             reverb.hiRatio.store(cfg.reverb.hiRatio, std::memory_order_relaxed);
             reverb.diffusion.store(cfg.reverb.diffusion, std::memory_order_relaxed);
@@ -181,10 +269,137 @@ struct SharedParams {
             multiband.subBassBoost.store(cfg.multiband.subBassBoost, std::memory_order_relaxed);
             multiband.subBassLowFreq.store(cfg.multiband.subBassLowFreq, std::memory_order_relaxed);
             multiband.subBassHighFreq.store(cfg.multiband.subBassHighFreq, std::memory_order_relaxed);
+            multiband.multirate.store(cfg.multiband.multirate, std::memory_order_relaxed);
         }
 
         if (cfg.audio.loaded) {
             blockSize.store(cfg.audio.blockSize, std::memory_order_relaxed);
+            pullMode.store(cfg.audio.pullMode, std::memory_order_relaxed);
+            targetLatencyMs.store(cfg.audio.targetLatencyMs, std::memory_order_relaxed);
         }
+
+        publish();
     }
+
+    // Control side (GUI thread, loaders): gathers the atomics into a new
+    // snapshot, bumping the version of each section that changed. Nothing is
+    // handed to the audio thread when no value moved.
+    void publish() {
+        ParamSnapshot& s = staged_;
+        bool dirty = false;
+
+        bool changed = false;
+        changed |= sync(s.compressor.volume, compressor.volume);
+        changed |= sync(s.compressor.attackMs, compressor.attackMs);
+        changed |= sync(s.compressor.releaseMs, compressor.releaseMs);
+        changed |= sync(s.compressor.ratio, compressor.ratio);
+        changed |= sync(s.compressor.thresholdDb, compressor.thresholdDb);
+        changed |= sync(s.compressor.makeupGainDb, compressor.makeupGainDb);
+        changed |= sync(s.compressor.sidechainFreqHz, compressor.sidechainFreqHz);
+        changed |= sync(s.compressor.preGainDb, compressor.preGainDb);
+        changed |= sync(s.compressor.kneeDb, compressor.kneeDb);
+        changed |= sync(s.compressor.expansionRatio, compressor.expansionRatio);
+        changed |= sync(s.compressor.gateThresholdDb, compressor.gateThresholdDb);
+        changed |= sync(s.compressor.enabled, compressor.enabled);
+        if (changed) { s.compressor.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.eq.enabled, eq.enabled);
+        changed |= sync(s.eq.linearPhase, eq.linearPhase);
+        changed |= sync(s.eq.preamp, eq.preamp);
+        int nBands = std::min(eq.numBands(), MAX_EQ_BANDS);
+        changed |= syncValue(s.eq.numBands, nBands);
+        for (int i = 0; i < nBands; i++) {
+            const BandParam& bp = eq.bands[i];
+            EQBandSettings& bs = s.eq.bands[i];
+            changed |= sync(bs.type, bp.type);
+            changed |= sync(bs.freq, bp.freq);
+            changed |= sync(bs.q, bp.q);
+            changed |= sync(bs.gainDb, bp.gainDb);
+        }
+        if (changed) { s.eq.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.tone.bassFreq, tone.bassFreq);
+        changed |= sync(s.tone.bassQ, tone.bassQ);
+        changed |= sync(s.tone.bassGainDb, tone.bassGainDb);
+        changed |= sync(s.tone.bassEnabled, tone.bassEnabled);
+        changed |= sync(s.tone.trebleFreq, tone.trebleFreq);
+        changed |= sync(s.tone.trebleQ, tone.trebleQ);
+        changed |= sync(s.tone.trebleGainDb, tone.trebleGainDb);
+        changed |= sync(s.tone.trebleEnabled, tone.trebleEnabled);
+        if (changed) { s.tone.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.reverb.enabled, reverb.enabled);
+        changed |= sync(s.reverb.algorithm, reverb.algorithm);
+        changed |= sync(s.reverb.decayTime, reverb.decayTime);
+        changed |= sync(s.reverb.hiRatio, reverb.hiRatio);
+        changed |= sync(s.reverb.diffusion, reverb.diffusion);
+        changed |= sync(s.reverb.initialDelay, reverb.initialDelay);
+        changed |= sync(s.reverb.density, reverb.density);
+        changed |= sync(s.reverb.lpfFreq, reverb.lpfFreq);
+        changed |= sync(s.reverb.hpfFreq, reverb.hpfFreq);
+        changed |= sync(s.reverb.reverbDelay, reverb.reverbDelay);
+        changed |= sync(s.reverb.balance, reverb.balance);
+        if (changed) { s.reverb.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.crossover.enabled, crossover.enabled);
+        changed |= sync(s.crossover.lpfEnabled, crossover.lpfEnabled);
+        changed |= sync(s.crossover.lowFreq, crossover.lowFreq);
+        changed |= sync(s.crossover.highFreq, crossover.highFreq);
+        changed |= sync(s.crossover.hpfSlope, crossover.hpfSlope);
+        changed |= sync(s.crossover.lpfSlope, crossover.lpfSlope);
+        changed |= sync(s.crossover.subGainDb, crossover.subGainDb);
+        if (changed) { s.crossover.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.bandLimiter.enabled, bandLimiter.enabled);
+        for (int i = 0; i < MAX_BL_ENTRIES; i++) {
+            changed |= sync(s.bandLimiter.entries[i].active, bandLimiter.entries[i].active);
+            changed |= sync(s.bandLimiter.entries[i].lowFreq, bandLimiter.entries[i].lowFreq);
+            changed |= sync(s.bandLimiter.entries[i].highFreq, bandLimiter.entries[i].highFreq);
+            changed |= sync(s.bandLimiter.entries[i].limitDb, bandLimiter.entries[i].limitDb);
+        }
+        if (changed) { s.bandLimiter.version++; dirty = true; }
+
+        changed = false;
+        changed |= sync(s.multiband.enabled, multiband.enabled);
+        changed |= sync(s.multiband.autoBalance, multiband.autoBalance);
+        changed |= sync(s.multiband.autoBalanceSpeed, multiband.autoBalanceSpeed);
+        changed |= sync(s.multiband.compression, multiband.compression);
+        changed |= sync(s.multiband.outputGain, multiband.outputGain);
+        changed |= sync(s.multiband.exciterAmount, multiband.exciterAmount);
+        changed |= sync(s.multiband.subBassBoost, multiband.subBassBoost);
+        changed |= sync(s.multiband.subBassLowFreq, multiband.subBassLowFreq);
+        changed |= sync(s.multiband.subBassHighFreq, multiband.subBassHighFreq);
+        changed |= sync(s.multiband.multirate, multiband.multirate);
+        if (changed) { s.multiband.version++; dirty = true; }
+
+        dirty |= sync(s.bypassAll, bypassAll);
+        if (!dirty) return;
+
+        snapshots_.getWriteBuffer() = s;
+        snapshots_.publish();
+    }
+
+    // Audio side: one atomic exchange per block at most.
+    const ParamSnapshot& acquireSnapshot() { return snapshots_.read(); }
+
+private:
+    template<typename T>
+    static bool sync(T& dst, const std::atomic<T>& src) {
+        return syncValue(dst, src.load(std::memory_order_relaxed));
+    }
+
+    template<typename T>
+    static bool syncValue(T& dst, const T& value) {
+        if (dst == value) return false;
+        dst = value;
+        return true;
+    }
+
+    ParamSnapshot staged_;
+    TripleBuffer<ParamSnapshot> snapshots_;
 };
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+// Meter values the audio thread publishes once per processed block. Readers
+// get a consistent copy through AudioEngine::getTelemetry() and never touch
+// DSP state themselves.
+struct Telemetry {
+    static constexpr int MAX_BANDS = 9;
+
+    // Decaying peaks, linear
+    float inputPeak[2] = {};
+    float outputPeak[2] = {};
+    float compressorGainReductionDb = 0.0f;
+    // Chain stages reset after putting out NaN or infinity, since prepare
+    uint32_t nonFiniteResets = 0;
+
+    // Multiband processor
+    int numBands = 0;
+    float bandLowFreq[MAX_BANDS] = {};
+    float bandHighFreq[MAX_BANDS] = {};
+    float bandEnergy[MAX_BANDS] = {};
+    float bandGainReductionDb[MAX_BANDS] = {};
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Single-producer / single-consumer triple buffer. The producer fills
+// getWriteBuffer() and publish()es it; the consumer always sees the most
+// recently published value. Neither side ever waits on the other.
+template<typename T>
+class TripleBuffer {
+public:
+    T& getWriteBuffer() { return slots_[back_]; }
+
+    void publish() {
+        uint8_t prev = middle_.exchange((uint8_t)(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = prev & INDEX_MASK;
+    }
+
+    const T& read() {
+        if (middle_.load(std::memory_order_relaxed) & FRESH) {
+            uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = prev & INDEX_MASK;
+        }
+        return slots_[front_];
+    }
+
+private:
+    static constexpr uint8_t FRESH = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    T slots_[3];
+    std::atomic<uint8_t> middle_{1};
+    uint8_t back_ = 0;
+    uint8_t front_ = 2;
+};
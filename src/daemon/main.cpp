@@ -0,0 +1,249 @@
+// Headless front end: loads config.json, runs the audio engine until SIGINT
+// or SIGTERM, and prints level/CPU status lines to stdout. With the null
+// backend it needs no sound hardware, which is what CI load tests use.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/audio_engine.h"
+#include "audio/audio_device.h"
+#include "dsp/cpu_dispatch.h"
+#include "dsp/dsp_chain.h"
+#include "common/params.h"
+#include "common/config_loader.h"
+
+namespace {
+
+std::atomic<bool> g_stopRequested{false};
+
+void onSignal(int) {
+    g_stopRequested.store(true, std::memory_order_relaxed);
+}
+
+struct Options {
+    std::string configPath = "config.json";
+    AudioBackend backend = AudioBackend::Auto;
+    std::string captureDevice;
+    std::string playbackDevice;
+    int blockSize = 0;
+    float pullTargetMs = 0.0f;
+    double durationSec = 0.0;
+    double statsIntervalSec = 5.0;
+    bool listDevices = false;
+};
+
+void printUsage(const char* argv0) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  -c, --config PATH      config file (default: config.json)\n"
+        "  -b, --backend NAME     auto, null, alsa, pulse or wasapi (default: auto)\n"
+        "      --capture DEVICE   capture device name or index (default: from config)\n"
+        "      --playback DEVICE  playback device name or index (default: from config)\n"
+        "      --block FRAMES     override audio.blockSize\n"
+        "      --pull MS          pull mode with MS of FIFO target (overrides audio.pullMode)\n"
+        "  -d, --duration SEC     stop after SEC seconds (default: run until signalled)\n"
+        "  -s, --stats SEC        status line interval, 0 to disable (default: 5)\n"
+        "      --isa NAME         DSP kernels: scalar, sse2, avx2, avx512 or neon (default: best supported)\n"
+        "  -l, --list-devices     list devices for the backend and exit\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        const char* value = nullptr;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (arg == "-l" || arg == "--list-devices") {
+            opt.listDevices = true;
+        } else if (arg == "-c" || arg == "--config") {
+            if (!(value = next())) return false;
+            opt.configPath = value;
+        } else if (arg == "-b" || arg == "--backend") {
+            if (!(value = next())) return false;
+            if (!parseAudioBackend(value, opt.backend)) {
+                std::fprintf(stderr, "Unknown backend '%s'\n", value);
+                return false;
+            }
+        } else if (arg == "--capture") {
+            if (!(value = next())) return false;
+            opt.captureDevice = value;
+        } else if (arg == "--playback") {
+            if (!(value = next())) return false;
+            opt.playbackDevice = value;
+        } else if (arg == "--block") {
+            if (!(value = next())) return false;
+            opt.blockSize = std::atoi(value);
+        } else if (arg == "--pull") {
+            if (!(value = next())) return false;
+            opt.pullTargetMs = (float)std::atof(value);
+        } else if (arg == "-d" || arg == "--duration") {
+            if (!(value = next())) return false;
+            opt.durationSec = std::atof(value);
+        } else if (arg == "-s" || arg == "--stats") {
+            if (!(value = next())) return false;
+            opt.statsIntervalSec = std::atof(value);
+        } else if (arg == "--isa") {
+            if (!(value = next())) return false;
+            dsp::Isa isa;
+            if (!dsp::parseIsa(value, isa)) {
+                std::fprintf(stderr, "Unknown instruction set '%s'\n", value);
+                return false;
+            }
+            if (!dsp::setIsa(isa)) {
+                std::fprintf(stderr, "%s kernels are not available on this machine\n", dsp::isaName(isa));
+                return false;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// A device may be given by list index or by exact name; -1 means the
+// backend's default device.
+int findDevice(const std::vector<AudioDeviceInfo>& devices, const std::string& spec) {
+    if (spec.empty()) return -1;
+
+    char* end = nullptr;
+    long index = std::strtol(spec.c_str(), &end, 10);
+    if (*end == '\0' && index >= 0 && index < (long)devices.size())
+        return (int)index;
+
+    for (const AudioDeviceInfo& dev : devices) {
+        if (dev.name == spec) return dev.index;
+    }
+    std::fprintf(stderr, "Device '%s' not found, using default\n", spec.c_str());
+    return -1;
+}
+
+void printDevices(const char* title, const std::vector<AudioDeviceInfo>& devices) {
+    std::printf("%s:\n", title);
+    for (const AudioDeviceInfo& dev : devices)
+        std::printf("  [%d]%s %s\n", dev.index, dev.isDefault ? " *" : "  ", dev.name.c_str());
+}
+
+void printStatus(const AudioEngine& engine, double elapsedSec) {
+    Telemetry meters = engine.getTelemetry();
+    std::printf("[%8.1fs] %s  %d Hz  %llu frames  in %.3f/%.3f  out %.3f/%.3f  gr %.1f dB  xruns %u/%u",
+                elapsedSec, AudioEngine::statusToString(engine.getStatus()),
+                engine.getDebugSampleRate(),
+                (unsigned long long)engine.getDebugFrameCount(),
+                meters.inputPeak[0], meters.inputPeak[1],
+                meters.outputPeak[0], meters.outputPeak[1],
+                meters.compressorGainReductionDb,
+                engine.getDebugUnderruns(), engine.getDebugOverruns());
+    if (engine.isPullMode())
+        std::printf("  latency %.1f ms  drift %+.0f ppm", engine.getDebugLatencyMs(), engine.getDebugDriftPpm());
+    if (meters.nonFiniteResets > 0)
+        std::printf("  nan resets %u", meters.nonFiniteResets);
+    std::printf("\n");
+#if DSP_PROFILING
+    for (int stage = 0; stage < StageProfiler::NUM_STAGES; stage++) {
+        StageProfiler::Stats s = engine.getDebugStageStats(stage);
+        if (s.count == 0) continue;
+        std::printf("    %-13s avg %7.1f us  p99 %7.1f us  max %7.1f us  load %5.2f%%\n",
+                    StageProfiler::getStageName(stage), s.avgUs, s.p99Us, s.maxUs, s.loadPercent);
+    }
+#endif
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    AudioDeviceManager deviceMgr;
+    if (!deviceMgr.init(opt.backend)) {
+        std::fprintf(stderr, "Could not initialise the %s backend\n", audioBackendName(opt.backend));
+        return 1;
+    }
+
+    bool loopback = audioBackendUsesLoopback(opt.backend);
+    std::vector<AudioDeviceInfo> playbackDevices = deviceMgr.enumeratePlaybackDevices();
+    std::vector<AudioDeviceInfo> captureDevices =
+        loopback ? playbackDevices : deviceMgr.enumerateCaptureDevices();
+
+    if (opt.listDevices) {
+        printDevices(loopback ? "Loopback sources" : "Capture devices", captureDevices);
+        printDevices("Playback devices", playbackDevices);
+        return 0;
+    }
+
+    AppConfig appConfig = config::loadConfig(opt.configPath);
+    SharedParams params;
+    params.loadFromConfig(appConfig);
+    if (opt.blockSize > 0)
+        params.blockSize.store(std::min(std::max(opt.blockSize, 64), 16384), std::memory_order_relaxed);
+    if (opt.pullTargetMs > 0.0f) {
+        params.pullMode.store(true, std::memory_order_relaxed);
+        params.targetLatencyMs.store(std::min(std::max(opt.pullTargetMs, 1.0f), 500.0f), std::memory_order_relaxed);
+    }
+
+    std::string captureSpec = !opt.captureDevice.empty() ? opt.captureDevice : appConfig.devices.captureFrom;
+    std::string playbackSpec = !opt.playbackDevice.empty() ? opt.playbackDevice : appConfig.devices.playTo;
+    int captureIdx = findDevice(captureDevices, captureSpec);
+    int playbackIdx = findDevice(playbackDevices, playbackSpec);
+
+    DSPChain dspChain(params);
+    AudioEngine engine(dspChain, params);
+    engine.setBackend(opt.backend);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    if (!engine.start(captureIdx, playbackIdx)) {
+        std::fprintf(stderr, "%s: %s\n", AudioEngine::statusToString(engine.getStatus()),
+                     engine.getErrorDetail().c_str());
+        return 1;
+    }
+    std::printf("Running on %s backend, block %d frames, %s kernels (Ctrl+C to stop)\n",
+                audioBackendName(opt.backend), params.blockSize.load(std::memory_order_relaxed),
+                dsp::isaName(dsp::activeIsa()));
+    std::fflush(stdout);
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point startTime = Clock::now();
+    double nextStats = opt.statsIntervalSec;
+
+    while (!g_stopRequested.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+        if (opt.statsIntervalSec > 0.0 && elapsed >= nextStats) {
+            printStatus(engine, elapsed);
+            nextStats += opt.statsIntervalSec;
+        }
+        if (opt.durationSec > 0.0 && elapsed >= opt.durationSec) break;
+        if (engine.getStatus() != AudioEngine::Status::Running) break;
+    }
+
+    bool failed = engine.getStatus() != AudioEngine::Status::Running;
+    printStatus(engine, std::chrono::duration<double>(Clock::now() - startTime).count());
+    engine.stop();
+    return failed ? 1 : 0;
+}
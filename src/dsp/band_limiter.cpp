@@ -2,65 +2,79 @@
 #include "dsp_common.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+
+void BandLimiter::prepare(float /*sampleRate*/, int maxBlockFrames, int /*numChannels*/, ScratchArena& arena) {
+    for (auto& buf : band_)
+        buf = arena.allocate<float>((size_t)maxBlockFrames);
+    reset();
+    lastVersion_ = ~0u;
+    lastSampleRate_ = 0.0f;
+}
+
+void BandLimiter::updateParams(const BandLimiterSettings& settings, float sampleRate) {
+    if (settings.version == lastVersion_ && sampleRate == lastSampleRate_) return;
+    bool rateChanged = (sampleRate != lastSampleRate_);
+    lastVersion_ = settings.version;
+    lastSampleRate_ = sampleRate;
+
+    float releaseCoeff = std::exp(-1.0f / (0.05f * sampleRate));
 
-void BandLimiter::updateParams(const BandLimiterParams& params, float sampleRate) {
     for (int e = 0; e < MAX_BL_ENTRIES; e++) {
         Entry& entry = entries_[e];
-        entry.active = params.entries[e].active.load(std::memory_order_relaxed);
+        const BandLimiterEntrySettings& es = settings.entries[e];
+        entry.active = es.active;
         if (!entry.active) continue;
 
-        float lowFreq = params.entries[e].lowFreq.load(std::memory_order_relaxed);
-        float highFreq = params.entries[e].highFreq.load(std::memory_order_relaxed);
-        float limitDb = params.entries[e].limitDb.load(std::memory_order_relaxed);
+        float lowFreq = es.lowFreq;
+        float highFreq = es.highFreq;
 
-        entry.limitLinear = dsp::dbToLinear(limitDb);
-        entry.releaseCoeff = std::exp(-1.0f / (0.05f * sampleRate));
+        entry.limitLinear = dsp::dbToLinear(es.limitDb);
+        entry.releaseCoeff = releaseCoeff;
 
-        if (lowFreq == entry.lastLowFreq && highFreq == entry.lastHighFreq)
+        if (!rateChanged && lowFreq == entry.lastLowFreq && highFreq == entry.lastHighFreq)
             continue;
 
         entry.lastLowFreq = lowFreq;
         entry.lastHighFreq = highFreq;
 
-        for (int ch = 0; ch < 2; ch++) {
-            for (int s = 0; s < STAGES; s++) {
-                entry.hpf[ch][s].setParams(Biquad::Type::HighPass, lowFreq, 0.0f, 0.707f, sampleRate);
-                entry.lpf[ch][s].setParams(Biquad::Type::LowPass, highFreq, 0.0f, 0.707f, sampleRate);
-            }
+        for (int s = 0; s < STAGES; s++) {
+            entry.hpf[s].setParams(Biquad::Type::HighPass, lowFreq, 0.0f, 0.707f, sampleRate);
+            entry.lpf[s].setParams(Biquad::Type::LowPass, highFreq, 0.0f, 0.707f, sampleRate);
         }
     }
 }
 
-void BandLimiter::process(float* buffer, int numFrames, int numChannels) {
-    int channels = std::min(numChannels, 2);
+void BandLimiter::process(float* const* channels, int numFrames, int numChannels) {
+    int count = std::min(numChannels, 2);
 
     for (int e = 0; e < MAX_BL_ENTRIES; e++) {
         if (!entries_[e].active) continue;
         Entry& entry = entries_[e];
 
-        for (int frame = 0; frame < numFrames; frame++) {
-            for (int ch = 0; ch < channels; ch++) {
-                int idx = frame * numChannels + ch;
-                float input = buffer[idx];
+        for (int ch = 0; ch < count; ch++)
+            std::memcpy(band_[ch], channels[ch], (size_t)numFrames * sizeof(float));
+        StereoBiquad::processCascade(entry.hpf, STAGES, band_, numFrames, count);
+        StereoBiquad::processCascade(entry.lpf, STAGES, band_, numFrames, count);
 
-                float band = input;
-                for (int s = 0; s < STAGES; s++)
-                    band = entry.hpf[ch][s].process(band);
-                for (int s = 0; s < STAGES; s++)
-                    band = entry.lpf[ch][s].process(band);
-
-                float absVal = std::abs(band);
-                if (absVal > entry.envState[ch])
-                    entry.envState[ch] = absVal;
+        for (int ch = 0; ch < count; ch++) {
+            float* samples = channels[ch];
+            const float* band = band_[ch];
+            float env = entry.envState[ch];
+            for (int frame = 0; frame < numFrames; frame++) {
+                float absVal = std::abs(band[frame]);
+                if (absVal > env)
+                    env = absVal;
                 else
-                    entry.envState[ch] *= entry.releaseCoeff;
+                    env *= entry.releaseCoeff;
 
                 float gain = 1.0f;
-                if (entry.envState[ch] > entry.limitLinear && entry.envState[ch] > 1e-10f)
-                    gain = entry.limitLinear / entry.envState[ch];
+                if (env > entry.limitLinear && env > 1e-10f)
+                    gain = entry.limitLinear / env;
 
-                buffer[idx] = input + band * (gain - 1.0f);
+                samples[frame] = samples[frame] + band[frame] * (gain - 1.0f);
             }
+            entry.envState[ch] = env;
         }
     }
 }
@@ -68,13 +82,12 @@ void BandLimiter::process(float* buffer, int numFrames, int numChannels) {
 void BandLimiter::reset() {
     for (int e = 0; e < MAX_BL_ENTRIES; e++) {
         Entry& entry = entries_[e];
-        for (int ch = 0; ch < 2; ch++) {
-            for (int s = 0; s < STAGES; s++) {
-                entry.hpf[ch][s].reset();
-                entry.lpf[ch][s].reset();
-            }
-            entry.envState[ch] = 0.0f;
+        for (int s = 0; s < STAGES; s++) {
+            entry.hpf[s].reset();
+            entry.lpf[s].reset();
         }
+        for (int ch = 0; ch < 2; ch++)
+            entry.envState[ch] = 0.0f;
         entry.lastLowFreq = 0;
         entry.lastHighFreq = 0;
     }
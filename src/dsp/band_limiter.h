@@ -1,6 +1,8 @@
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include "biquad.h"
+#include "scratch_arena.h"
 
 static constexpr int MAX_BL_ENTRIES = 4;
 
@@ -16,10 +18,24 @@ struct BandLimiterParams {
     BandLimiterEntryParams entries[MAX_BL_ENTRIES];
 };
 
+struct BandLimiterEntrySettings {
+    bool  active = false;
+    float lowFreq = 20.0f;
+    float highFreq = 70.0f;
+    float limitDb = 0.0f;
+};
+
+struct BandLimiterSettings {
+    bool enabled = false;
+    BandLimiterEntrySettings entries[MAX_BL_ENTRIES];
+    uint32_t version = 0;
+};
+
 class BandLimiter {
 public:
-    void updateParams(const BandLimiterParams& params, float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void updateParams(const BandLimiterSettings& settings, float sampleRate);
+    void process(float* const* channels, int numFrames, int numChannels);
     void reset();
 
 private:
@@ -29,8 +45,8 @@ private:
         bool active = false;
         float limitLinear = 1.0f;
 
-        Biquad hpf[2][STAGES];
-        Biquad lpf[2][STAGES];
+        StereoBiquad hpf[STAGES];
+        StereoBiquad lpf[STAGES];
 
         float envState[2] = {};
         float releaseCoeff = 0.0f;
@@ -40,4 +56,8 @@ private:
     };
 
     Entry entries_[MAX_BL_ENTRIES];
+    // The limited band of the current block, per channel
+    float* band_[2] = {};
+    uint32_t lastVersion_ = ~0u;
+    float lastSampleRate_ = 0.0f;
 };
@@ -1,14 +1,25 @@
 #include "biquad.h"
+#include "cpu_dispatch.h"
 #include "dsp_common.h"
+#include "scratch_arena.h"
+#include <algorithm>
 #include <cmath>
 
-void Biquad::setParams(Type type, float freqHz, float gainDb, float Q, float sampleRate) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BIQUAD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BIQUAD_NEON 1
+#endif
+
+BiquadCoeffs Biquad::design(Type type, float freqHz, float gainDb, float Q, float sampleRate) {
     float omega = 2.0f * dsp::PI * freqHz / sampleRate;
     float sinW = std::sin(omega);
     float cosW = std::cos(omega);
     float alpha = sinW / (2.0f * Q);
 
-    float b0, b1, b2, a0, a1, a2;
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a0 = 1.0f, a1 = 0.0f, a2 = 0.0f;
 
     switch (type) {
     case Type::PeakingEQ: {
@@ -70,14 +81,54 @@ void Biquad::setParams(Type type, float freqHz, float gainDb, float Q, float sam
         a2 =  1.0f - alpha;
         break;
     }
+    case Type::AllPass: {
+        b0 =  1.0f - alpha;
+        b1 = -2.0f * cosW;
+        b2 =  1.0f + alpha;
+        a0 =  1.0f + alpha;
+        a1 = -2.0f * cosW;
+        a2 =  1.0f - alpha;
+        break;
+    }
     }
 
     float invA0 = 1.0f / a0;
-    b0_ = b0 * invA0;
-    b1_ = b1 * invA0;
-    b2_ = b2 * invA0;
-    a1_ = a1 * invA0;
-    a2_ = a2 * invA0;
+    BiquadCoeffs c;
+    c.b0 = b0 * invA0;
+    c.b1 = b1 * invA0;
+    c.b2 = b2 * invA0;
+    c.a1 = a1 * invA0;
+    c.a2 = a2 * invA0;
+    return c;
+}
+
+double Biquad::magnitude(const BiquadCoeffs& c, double omega) {
+    double cos1 = std::cos(omega), sin1 = std::sin(omega);
+    double cos2 = std::cos(2.0 * omega), sin2 = std::sin(2.0 * omega);
+
+    double numRe = c.b0 + c.b1 * cos1 + c.b2 * cos2;
+    double numIm = -(c.b1 * sin1 + c.b2 * sin2);
+    double denRe = 1.0 + c.a1 * cos1 + c.a2 * cos2;
+    double denIm = -(c.a1 * sin1 + c.a2 * sin2);
+
+    return std::sqrt((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+}
+
+bool Biquad::isIdentity(const BiquadCoeffs& c) {
+    constexpr float EPS = 1e-6f;
+    return std::abs(c.b0 - 1.0f) <= EPS && std::abs(c.b1 - c.a1) <= EPS && std::abs(c.b2 - c.a2) <= EPS;
+}
+
+void Biquad::setParams(Type type, float freqHz, float gainDb, float Q, float sampleRate) {
+    setCoeffs(design(type, freqHz, gainDb, Q, sampleRate));
+}
+
+void Biquad::setCoeffs(const BiquadCoeffs& c) {
+    b0_ = c.b0;
+    b1_ = c.b1;
+    b2_ = c.b2;
+    a1_ = c.a1;
+    a2_ = c.a2;
 }
 
 float Biquad::process(float input) {
@@ -92,3 +143,116 @@ void Biquad::reset() {
     z1_ = 0.0f;
     z2_ = 0.0f;
 }
+
+void StereoBiquad::setParams(Biquad::Type type, float freqHz, float gainDb, float Q, float sampleRate) {
+    c_ = Biquad::design(type, freqHz, gainDb, Q, sampleRate);
+}
+
+void StereoBiquad::setCoeffs(const BiquadCoeffs& c) {
+    c_ = c;
+}
+
+void StereoBiquad::processBlock(float* const* channels, int numFrames, int numChannels) {
+    dsp::kernels().biquadCascade(&c_, &s_, 1, channels, numFrames, numChannels);
+}
+
+void StereoBiquad::processCascade(StereoBiquad* filters, int count, float* const* channels,
+                                  int numFrames, int numChannels) {
+    // The kernel wants coefficients and state as two flat arrays
+    constexpr int CHUNK = 16;
+    BiquadCoeffs coeffs[CHUNK];
+    StereoBiquadState state[CHUNK];
+    const dsp::Kernels& k = dsp::kernels();
+
+    for (int first = 0; first < count; first += CHUNK) {
+        int n = std::min(CHUNK, count - first);
+        for (int i = 0; i < n; i++) {
+            coeffs[i] = filters[first + i].c_;
+            state[i] = filters[first + i].s_;
+        }
+        k.biquadCascade(coeffs, state, n, channels, numFrames, numChannels);
+        for (int i = 0; i < n; i++)
+            filters[first + i].s_ = state[i];
+    }
+}
+
+void BiquadCascade::prepare(int maxSections, ScratchArena& arena) {
+    coeffs_ = arena.allocate<BiquadCoeffs>((size_t)maxSections);
+    state_ = arena.allocate<StereoBiquadState>((size_t)maxSections);
+    filters_ = arena.allocate<StereoBiquad*>((size_t)maxSections);
+    maxSections_ = maxSections;
+    count_ = 0;
+}
+
+void BiquadCascade::append(StereoBiquad& filter, float gain) {
+    if (count_ == maxSections_) return;
+    BiquadCoeffs& c = coeffs_[count_];
+    c = filter.c_;
+    c.b0 *= gain;
+    c.b1 *= gain;
+    c.b2 *= gain;
+    filters_[count_] = &filter;
+    count_++;
+}
+
+void BiquadCascade::process(float* const* channels, int numFrames, int numChannels) {
+    for (int i = 0; i < count_; i++)
+        state_[i] = filters_[i]->s_;
+    dsp::kernels().biquadCascade(coeffs_, state_, count_, channels, numFrames, numChannels);
+    for (int i = 0; i < count_; i++)
+        filters_[i]->s_ = state_[i];
+}
+
+#if defined(BIQUAD_SSE)
+
+void StereoBiquad::process(float& left, float& right) {
+    __m128 x = _mm_setr_ps(left, right, 0.0f, 0.0f);
+    __m128 z1 = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(s_.z1)));
+    __m128 z2 = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(s_.z2)));
+    __m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c_.b0), x), z1);
+    z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c_.b1), x),
+                               _mm_mul_ps(_mm_set1_ps(c_.a1), y)), z2);
+    z2 = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c_.b2), x), _mm_mul_ps(_mm_set1_ps(c_.a2), y));
+    _mm_store_sd(reinterpret_cast<double*>(s_.z1), _mm_castps_pd(z1));
+    _mm_store_sd(reinterpret_cast<double*>(s_.z2), _mm_castps_pd(z2));
+
+    alignas(16) float out[4];
+    _mm_store_ps(out, y);
+    left = out[0];
+    right = out[1];
+}
+
+#elif defined(BIQUAD_NEON)
+
+void StereoBiquad::process(float& left, float& right) {
+    float in[2] = { left, right };
+    float32x2_t x = vld1_f32(in);
+    float32x2_t z1 = vld1_f32(s_.z1);
+    float32x2_t z2 = vld1_f32(s_.z2);
+    float32x2_t y = vmla_f32(z1, vdup_n_f32(c_.b0), x);
+    z1 = vmls_f32(vmla_f32(z2, vdup_n_f32(c_.b1), x), vdup_n_f32(c_.a1), y);
+    z2 = vmls_f32(vmul_f32(vdup_n_f32(c_.b2), x), vdup_n_f32(c_.a2), y);
+    vst1_f32(s_.z1, z1);
+    vst1_f32(s_.z2, z2);
+    left = vget_lane_f32(y, 0);
+    right = vget_lane_f32(y, 1);
+}
+
+#else
+
+void StereoBiquad::process(float& left, float& right) {
+    float* io[2] = { &left, &right };
+    for (int ch = 0; ch < 2; ch++) {
+        float x = *io[ch];
+        float y = c_.b0 * x + s_.z1[ch];
+        s_.z1[ch] = c_.b1 * x - c_.a1 * y + s_.z2[ch];
+        s_.z2[ch] = c_.b2 * x - c_.a2 * y;
+        *io[ch] = y;
+    }
+}
+
+#endif
+
+void StereoBiquad::reset() {
+    s_ = StereoBiquadState();
+}
@@ -1,56 +1,71 @@
 #include "compressor.h"
+#include "cpu_dispatch.h"
 #include "dsp_common.h"
 #include <cmath>
 #include <algorithm>
 
 Compressor::Compressor() = default;
 
-void Compressor::updateParams(const CompressorParams& params, float sampleRate) {
-    thresholdDb_ = params.thresholdDb.load(std::memory_order_relaxed);
-    ratio_ = std::max(1.0f, params.ratio.load(std::memory_order_relaxed));
-    volumeLinear_ = params.volume.load(std::memory_order_relaxed);
-    makeupGainLinear_ = dsp::dbToLinear(params.makeupGainDb.load(std::memory_order_relaxed));
-    preGainLinear_ = dsp::dbToLinear(params.preGainDb.load(std::memory_order_relaxed));
-    kneeDb_ = std::max(0.0f, params.kneeDb.load(std::memory_order_relaxed));
-    expansionRatio_ = std::max(1.0f, params.expansionRatio.load(std::memory_order_relaxed));
-    gateThresholdDb_ = params.gateThresholdDb.load(std::memory_order_relaxed);
-
-    float attackMs = std::max(0.01f, params.attackMs.load(std::memory_order_relaxed));
-    float releaseMs = std::max(0.01f, params.releaseMs.load(std::memory_order_relaxed));
+void Compressor::prepare(float /*sampleRate*/, int maxBlockFrames, int /*numChannels*/, ScratchArena& arena) {
+    frameGains_ = arena.allocate<float>((size_t)maxBlockFrames);
+    reset();
+    // Forces coefficients and the sidechain filter to be redesigned
+    lastVersion_ = ~0u;
+    lastSampleRate_ = 0.0f;
+}
+
+void Compressor::updateParams(const CompressorSettings& settings, float sampleRate) {
+    if (settings.version == lastVersion_ && sampleRate == lastSampleRate_) return;
+    bool rateChanged = (sampleRate != lastSampleRate_);
+    lastVersion_ = settings.version;
+    lastSampleRate_ = sampleRate;
+
+    thresholdDb_ = settings.thresholdDb;
+    ratio_ = std::max(1.0f, settings.ratio);
+    volumeLinear_ = settings.volume;
+    makeupGainLinear_ = dsp::dbToLinear(settings.makeupGainDb);
+    preGainLinear_ = dsp::dbToLinear(settings.preGainDb);
+    kneeDb_ = std::max(0.0f, settings.kneeDb);
+    expansionRatio_ = std::max(1.0f, settings.expansionRatio);
+    gateThresholdDb_ = settings.gateThresholdDb;
+
+    float attackMs = std::max(0.01f, settings.attackMs);
+    float releaseMs = std::max(0.01f, settings.releaseMs);
     attackCoeff_ = std::exp(-1.0f / (attackMs * 0.001f * sampleRate));
     releaseCoeff_ = std::exp(-1.0f / (releaseMs * 0.001f * sampleRate));
 
-    float newFreq = params.sidechainFreqHz.load(std::memory_order_relaxed);
-    if (newFreq != sidechainFreq_) {
+    float newFreq = settings.sidechainFreqHz;
+    if (newFreq != sidechainFreq_ || rateChanged) {
         sidechainFreq_ = newFreq;
         if (newFreq > 20.0f) {
             sidechainEnabled_ = true;
-            for (int ch = 0; ch < 2; ch++)
-                sidechainFilter_[ch].setParams(Biquad::Type::HighPass, newFreq, 0.0f, 0.707f, sampleRate);
+            sidechainFilter_.setParams(Biquad::Type::HighPass, newFreq, 0.0f, 0.707f, sampleRate);
         } else {
             sidechainEnabled_ = false;
-            for (int ch = 0; ch < 2; ch++)
-                sidechainFilter_[ch].reset();
+            sidechainFilter_.reset();
         }
     }
 }
 
-void Compressor::process(float* buffer, int numFrames, int numChannels) {
-    int channels = std::min(numChannels, 2);
+void Compressor::process(float* const* channels, int numFrames, int numChannels) {
+    int count = std::min(numChannels, 2);
     float maxCompression = 0.0f;
     float kneeHalf = kneeDb_ * 0.5f;
 
+    const dsp::Kernels& k = dsp::kernels();
+    for (int ch = 0; ch < numChannels; ch++)
+        k.applyGain(channels[ch], (size_t)numFrames, preGainLinear_);
+
+    const float* left = channels[0];
+    const float* right = (count > 1) ? channels[1] : nullptr;
     for (int frame = 0; frame < numFrames; frame++) {
-        for (int ch = 0; ch < numChannels; ch++)
-            buffer[frame * numChannels + ch] *= preGainLinear_;
+        float sc[2] = { left[frame], right ? right[frame] : 0.0f };
+        if (sidechainEnabled_)
+            sidechainFilter_.process(sc[0], sc[1]);
 
         float peakLevel = 0.0f;
-        for (int ch = 0; ch < channels; ch++) {
-            int idx = frame * numChannels + ch;
-            float sample = buffer[idx];
-            if (sidechainEnabled_)
-                sample = sidechainFilter_[ch].process(sample);
-            float absVal = std::abs(sample);
+        for (int ch = 0; ch < count; ch++) {
+            float absVal = std::abs(sc[ch]);
             if (absVal > peakLevel) peakLevel = absVal;
         }
 
@@ -89,9 +104,13 @@ void Compressor::process(float* buffer, int numFrames, int numChannels) {
         if (compressionDb > maxCompression) maxCompression = compressionDb;
 
         float gainLinear = dsp::dbToLinear(-totalReductionDb);
-        float totalGain = gainLinear * makeupGainLinear_ * volumeLinear_;
-        for (int ch = 0; ch < numChannels; ch++)
-            buffer[frame * numChannels + ch] *= totalGain;
+        frameGains_[frame] = gainLinear * makeupGainLinear_ * volumeLinear_;
+    }
+
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* samples = channels[ch];
+        for (int frame = 0; frame < numFrames; frame++)
+            samples[frame] *= frameGains_[frame];
     }
 
     currentGainReductionDb_.store(maxCompression, std::memory_order_relaxed);
@@ -99,7 +118,6 @@ void Compressor::process(float* buffer, int numFrames, int numChannels) {
 
 void Compressor::reset() {
     envDb_ = -96.0f;
-    for (int ch = 0; ch < 2; ch++)
-        sidechainFilter_[ch].reset();
+    sidechainFilter_.reset();
     currentGainReductionDb_.store(0.0f, std::memory_order_relaxed);
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "biquad.h"
+#include "scratch_arena.h"
 #include "common/params.h"
 #include <atomic>
 
@@ -7,8 +8,9 @@ class Compressor {
 public:
     Compressor();
 
-    void updateParams(const CompressorParams& params, float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void updateParams(const CompressorSettings& settings, float sampleRate);
+    void process(float* const* channels, int numFrames, int numChannels);
     void reset();
 
     float getGainReduction() const {
@@ -30,9 +32,15 @@ private:
     float expansionRatio_ = 1.0f;
     float gateThresholdDb_ = -90.0f;
 
-    Biquad sidechainFilter_[2];
+    // Per-frame gain of the current block, applied once detection is done
+    float* frameGains_ = nullptr;
+
+    StereoBiquad sidechainFilter_;
     float sidechainFreq_ = 0.0f;
     bool sidechainEnabled_ = false;
 
+    uint32_t lastVersion_ = ~0u;
+    float lastSampleRate_ = 0.0f;
+
     std::atomic<float> currentGainReductionDb_{0.0f};
 };
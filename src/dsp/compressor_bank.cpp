@@ -0,0 +1,79 @@
+#include "compressor_bank.h"
+#include "dsp_common.h"
+#include <algorithm>
+#include <cmath>
+
+void CompressorBank::prepare(int numLanes, int maxBlockFrames, ScratchArena& arena) {
+    numLanes_ = std::max(1, std::min(numLanes, MAX_LANES));
+    peaks_ = arena.allocate<float>((size_t)maxBlockFrames * numLanes_);
+    gains_ = arena.allocate<float>((size_t)maxBlockFrames * numLanes_);
+    reset();
+    lastVersion_ = ~0u;
+    lastSampleRate_ = 0.0f;
+}
+
+void CompressorBank::updateParams(const CompressorSettings& settings, float sampleRate) {
+    if (settings.version == lastVersion_ && sampleRate == lastSampleRate_) return;
+    lastVersion_ = settings.version;
+    lastSampleRate_ = sampleRate;
+
+    outputGainLinear_ = dsp::dbToLinear(settings.makeupGainDb) * settings.volume;
+    preGainLinear_ = dsp::dbToLinear(settings.preGainDb);
+
+    float ratio = std::max(1.0f, settings.ratio);
+    float kneeDb = std::max(0.0f, settings.kneeDb);
+    float expansionRatio = std::max(1.0f, settings.expansionRatio);
+    float attackMs = std::max(0.01f, settings.attackMs);
+    float releaseMs = std::max(0.01f, settings.releaseMs);
+
+    dsp::BankGainComputer& gc = gainComputer_;
+    gc.attackCoeff = std::exp(-1.0f / (attackMs * 0.001f * sampleRate));
+    gc.releaseCoeff = std::exp(-1.0f / (releaseMs * 0.001f * sampleRate));
+    gc.thresholdDb = settings.thresholdDb;
+    gc.slope = 1.0f - 1.0f / ratio;
+    gc.kneeBottomDb = settings.thresholdDb - kneeDb * 0.5f;
+    gc.kneeTopDb = settings.thresholdDb + kneeDb * 0.5f;
+    // Knee disabled: a curve that is never selected, without dividing by 0
+    gc.kneeScale = kneeDb > 0.0f ? (1.0f - 1.0f / ratio) / (2.0f * kneeDb) : 0.0f;
+    gc.expansionSlope = expansionRatio > 1.0f ? 1.0f - 1.0f / expansionRatio : 0.0f;
+    gc.gateThresholdDb = settings.gateThresholdDb;
+}
+
+void CompressorBank::reset() {
+    std::fill(std::begin(envDb_), std::end(envDb_), -96.0f);
+    std::fill(std::begin(gainReductionDb_), std::end(gainReductionDb_), 0.0f);
+}
+
+void CompressorBank::process(float* const* const* lanes, const float* laneGains, int numFrames, int numChannels) {
+    const dsp::Kernels& k = dsp::kernels();
+    detectPeaks(lanes, numFrames, numChannels);
+
+    alignas(64) float outGains[MAX_LANES] = {};
+    for (int lane = 0; lane < numLanes_; lane++)
+        outGains[lane] = laneGains[lane] * preGainLinear_ * outputGainLinear_;
+    k.compressorBank(peaks_, gains_, (size_t)numFrames, numLanes_, numFrames, gainComputer_,
+                     outGains, envDb_, gainReductionDb_);
+
+    for (int lane = 0; lane < numLanes_; lane++) {
+        float* const* channels = lanes[lane];
+        if (!channels) continue;
+        const float* g = gains_ + (size_t)lane * numFrames;
+        for (int ch = 0; ch < numChannels; ch++)
+            k.multiply(channels[ch], g, (size_t)numFrames);
+    }
+}
+
+void CompressorBank::detectPeaks(float* const* const* lanes, int numFrames, int numChannels) {
+    for (int lane = 0; lane < numLanes_; lane++) {
+        float* row = peaks_ + (size_t)lane * numFrames;
+        float* const* channels = lanes[lane];
+        if (!channels) {
+            std::fill(row, row + numFrames, 0.0f);
+            continue;
+        }
+        const float* left = channels[0];
+        const float* right = (numChannels > 1) ? channels[1] : left;
+        for (int frame = 0; frame < numFrames; frame++)
+            row[frame] = std::max(std::abs(left[frame]), std::abs(right[frame])) * preGainLinear_;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "cpu_dispatch.h"
+#include "scratch_arena.h"
+#include "common/params.h"
+
+// Several linked-stereo compressors sharing one CompressorSettings, run as
+// the lanes of the compressorBank kernel so the per-sample envelope and gain
+// computer go across lanes in SIMD registers. Matches Compressor apart from
+// the sidechain filter, which the bank does not have.
+class CompressorBank {
+public:
+    static constexpr int MAX_LANES = dsp::COMPRESSOR_BANK_LANES;
+
+    void prepare(int numLanes, int maxBlockFrames, ScratchArena& arena);
+    void updateParams(const CompressorSettings& settings, float sampleRate);
+
+    // Compresses the planar block (one array per channel) of every lane
+    // whose pointer is set, then scales it by that lane's laneGains entry.
+    // Lanes without a block see silence.
+    void process(float* const* const* lanes, const float* laneGains, int numFrames, int numChannels);
+    void reset();
+
+    // Deepest compression (not gate or expansion) of the lane in the last
+    // block, like Compressor::getGainReduction(). Audio thread only.
+    float getGainReduction(int lane) const { return gainReductionDb_[lane]; }
+
+private:
+    void detectPeaks(float* const* const* lanes, int numFrames, int numChannels);
+
+    int numLanes_ = 0;
+    // One row of numFrames per lane
+    float* peaks_ = nullptr;
+    float* gains_ = nullptr;
+
+    alignas(64) float envDb_[MAX_LANES] = {};
+    alignas(64) float gainReductionDb_[MAX_LANES] = {};
+
+    dsp::BankGainComputer gainComputer_ = {};
+    float outputGainLinear_ = 1.0f;   // makeup * volume
+    float preGainLinear_ = 1.0f;
+
+    uint32_t lastVersion_ = ~0u;
+    float lastSampleRate_ = 0.0f;
+};
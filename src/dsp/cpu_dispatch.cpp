@@ -0,0 +1,143 @@
+#include "cpu_dispatch.h"
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace dsp {
+
+namespace {
+
+std::atomic<const Kernels*> g_active{nullptr};
+
+const Kernels* tableFor(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return scalarKernels();
+        case Isa::SSE2:   return sse2Kernels();
+        case Isa::AVX2:   return avx2Kernels();
+        case Isa::AVX512: return avx512Kernels();
+        case Isa::NEON:   return neonKernels();
+    }
+    return nullptr;
+}
+
+bool cpuHas(Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    // libgcc and compiler-rt also check that the OS saves the YMM/ZMM state
+    __builtin_cpu_init();
+    switch (isa) {
+        case Isa::SSE2:   return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case Isa::AVX512: return __builtin_cpu_supports("avx512f");
+        default:          return isa == Isa::Scalar;
+    }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0);
+    int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    bool sse2 = (regs[3] & (1 << 26)) != 0;
+    bool fma = (regs[2] & (1 << 12)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool ymmState = (xcr0 & 0x06) == 0x06;
+    bool zmmState = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = false, avx512f = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+        avx512f = (regs[1] & (1 << 16)) != 0;
+    }
+    switch (isa) {
+        case Isa::SSE2:   return sse2;
+        case Isa::AVX2:   return avx2 && fma && ymmState;
+        case Isa::AVX512: return avx512f && zmmState;
+        default:          return isa == Isa::Scalar;
+    }
+#elif defined(__ARM_NEON)
+    return isa == Isa::Scalar || isa == Isa::NEON;
+#else
+    return isa == Isa::Scalar;
+#endif
+}
+
+const Kernels* selectDefault() {
+    Isa isa = detectIsa();
+    if (const char* env = std::getenv("AUDIOEQ_ISA")) {
+        Isa requested;
+        if (parseIsa(env, requested) && isaSupported(requested))
+            isa = requested;
+    }
+    return tableFor(isa);
+}
+
+} // namespace
+
+const Kernels& kernels() {
+    const Kernels* k = g_active.load(std::memory_order_acquire);
+    if (!k) {
+        // Racing first calls pick the same table; a setIsa() that got in
+        // first wins
+        const Kernels* chosen = selectDefault();
+        if (g_active.compare_exchange_strong(k, chosen, std::memory_order_acq_rel))
+            k = chosen;
+    }
+    return *k;
+}
+
+Isa activeIsa() {
+    return kernels().isa;
+}
+
+Isa detectIsa() {
+    static const Isa order[] = { Isa::AVX512, Isa::AVX2, Isa::NEON, Isa::SSE2 };
+    for (Isa isa : order) {
+        if (isaSupported(isa)) return isa;
+    }
+    return Isa::Scalar;
+}
+
+bool isaSupported(Isa isa) {
+    return tableFor(isa) != nullptr && cpuHas(isa);
+}
+
+bool setIsa(Isa isa) {
+    if (!isaSupported(isa)) return false;
+    g_active.store(tableFor(isa), std::memory_order_release);
+    return true;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        case Isa::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+bool parseIsa(const char* name, Isa& isa) {
+    static const Isa all[] = { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512, Isa::NEON };
+    char lower[16] = {};
+    size_t len = std::strlen(name);
+    if (len >= sizeof(lower)) return false;
+    for (size_t i = 0; i < len; i++)
+        lower[i] = (char)std::tolower((unsigned char)name[i]);
+
+    for (Isa candidate : all) {
+        if (std::strcmp(lower, isaName(candidate)) == 0) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace dsp
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include "biquad.h"
+
+namespace dsp {
+
+// Instruction sets with their own kernel build. AVX2 implies FMA.
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+// Lanes of the comb bank kernel: one per comb, padded to a whole AVX-512
+// register.
+constexpr int COMB_BANK_LANES = 16;
+
+// Lanes of the compressor bank kernel's per-lane arrays: one AVX-512
+// register, so every variant can load and store them whole.
+constexpr int COMPRESSOR_BANK_LANES = 16;
+
+// Gain computer shared by the lanes of a compressor bank. Levels are in dB.
+struct BankGainComputer {
+    float attackCoeff;
+    float releaseCoeff;
+    float thresholdDb;
+    float slope;            // 1 - 1 / ratio
+    float kneeBottomDb;
+    float kneeTopDb;
+    float kneeScale;        // zero with the knee off
+    float expansionSlope;   // zero with expansion off
+    float gateThresholdDb;
+};
+
+// The hot inner loops, one table per instruction set. Every variant reads
+// and leaves its state in the same layout, so the active table can change
+// between any two calls.
+struct Kernels {
+    Isa isa;
+
+    // numSections biquads in series over channels 0 and 1 of a planar
+    // block, like calling StereoBiquad::processBlock on each in turn. The
+    // vector variants run several sections at once, each one frame behind
+    // the one before it.
+    void (*biquadCascade)(const BiquadCoeffs* coeffs, StereoBiquadState* state, int numSections,
+                          float* const* channels, int numFrames, int numChannels);
+
+    // One tile of a bank of damped feedback combs sharing an input. taps holds
+    // numFrames rows of COMB_BANK_LANES delayed samples; each is replaced by
+    // the value to write back into its line. output receives the sum of the
+    // delayed samples weighted by gain. Unused lanes need zero gain and
+    // feedback. The tile must be no longer than the shortest line.
+    void (*combBank)(float* taps, const float* input, float* filterState, const float* feedback,
+                     const float* gain, float damping, float* output, int numFrames);
+
+    // A bank of linked compressors, one per lane, over lane-major blocks:
+    // peaks holds numLanes rows of numFrames detector levels, stride floats
+    // apart, and gains receives every frame's linear gain times the lane's
+    // outGain in the same layout. envDb carries the envelopes from block to
+    // block and reductionDb receives each lane's deepest compression (not
+    // gate or expansion); these and outGain have COMPRESSOR_BANK_LANES
+    // entries, whatever numLanes is.
+    void (*compressorBank)(const float* peaks, float* gains, size_t stride, int numLanes,
+                           int numFrames, const BankGainComputer& gc, const float* outGain,
+                           float* envDb, float* reductionDb);
+
+    void (*applyGain)(float* samples, size_t count, float gain);
+    // samples[i] *= gains[i]
+    void (*multiply)(float* samples, const float* gains, size_t count);
+
+    // Largest magnitude on channels 0 and 1; peakR is zero for mono.
+    void (*peakLevels)(const float* interleaved, int numFrames, int numChannels,
+                       float& peakL, float& peakR);
+
+    // Bends every sample beyond +-threshold towards +-1 along a tanh curve.
+    void (*softClip)(float* samples, size_t count, float threshold);
+
+    // Between an interleaved device buffer and one array per channel.
+    void (*deinterleave)(const float* interleaved, float* const* channels, int numFrames,
+                         int numChannels);
+    void (*interleave)(const float* const* channels, float* interleaved, int numFrames,
+                       int numChannels);
+};
+
+// The active table. Chosen on first use: the best set the CPU and OS
+// support, or the one named by the AUDIOEQ_ISA environment variable.
+const Kernels& kernels();
+
+Isa activeIsa();
+// Best instruction set available on this machine.
+Isa detectIsa();
+bool isaSupported(Isa isa);
+// Switches every later kernel call to isa. Fails, leaving the table as it
+// was, when the build or the CPU lacks it. Safe from any thread.
+bool setIsa(Isa isa);
+
+const char* isaName(Isa isa);
+// Case-insensitive; accepts the names isaName returns.
+bool parseIsa(const char* name, Isa& isa);
+
+// Per-ISA tables, defined each in its own translation unit. Null when the
+// variant is not built for this target.
+const Kernels* scalarKernels();
+const Kernels* sse2Kernels();
+const Kernels* avx2Kernels();
+const Kernels* avx512Kernels();
+const Kernels* neonKernels();
+
+} // namespace dsp
@@ -2,6 +2,7 @@
 #include "dsp_common.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 
 static int slopeToStages(int slope) {
     switch (slope) {
@@ -13,15 +14,25 @@ static int slopeToStages(int slope) {
     }
 }
 
-void Crossover::updateParams(const CrossoverParams& params, float sampleRate) {
-    float lowFreq = params.lowFreq.load(std::memory_order_relaxed);
-    float highFreq = params.highFreq.load(std::memory_order_relaxed);
-    int hpfSlope = params.hpfSlope.load(std::memory_order_relaxed);
-    int lpfSlope = params.lpfSlope.load(std::memory_order_relaxed);
-    float subGainDb = params.subGainDb.load(std::memory_order_relaxed);
+void Crossover::prepare(float /*sampleRate*/, int maxBlockFrames, int /*numChannels*/, ScratchArena& arena) {
+    for (auto& buf : sub_)
+        buf = arena.allocate<float>((size_t)maxBlockFrames);
+    reset();
+    lastSampleRate_ = 0;
+    lastVersion_ = ~0u;
+}
+
+void Crossover::updateParams(const CrossoverSettings& settings, float sampleRate) {
+    if (settings.version == lastVersion_ && sampleRate == lastSampleRate_) return;
+    lastVersion_ = settings.version;
 
-    subGainLinear_ = dsp::dbToLinear(subGainDb);
-    lpfEnabled_ = params.lpfEnabled.load(std::memory_order_relaxed);
+    float lowFreq = settings.lowFreq;
+    float highFreq = settings.highFreq;
+    int hpfSlope = settings.hpfSlope;
+    int lpfSlope = settings.lpfSlope;
+
+    subGainLinear_ = dsp::dbToLinear(settings.subGainDb);
+    lpfEnabled_ = settings.lpfEnabled;
     hpfSlope_ = hpfSlope;
     lpfSlope_ = lpfSlope;
 
@@ -41,65 +52,80 @@ void Crossover::updateParams(const CrossoverParams& params, float sampleRate) {
     if (hpfSlope == 6) {
         hpfOnePoleCoeff_ = 1.0f - std::exp(-2.0f * dsp::PI * lowFreq / sampleRate);
     } else {
-        for (int ch = 0; ch < 2; ch++)
-            for (int s = 0; s < hpfStages_; s++)
-                hpf_[ch][s].setParams(Biquad::Type::HighPass, lowFreq, 0.0f, 0.707f, sampleRate);
+        for (int s = 0; s < hpfStages_; s++)
+            hpf_[s].setParams(Biquad::Type::HighPass, lowFreq, 0.0f, 0.707f, sampleRate);
     }
 
     lpfStages_ = slopeToStages(lpfSlope);
     if (lpfSlope == 6) {
         lpfOnePoleCoeff_ = 1.0f - std::exp(-2.0f * dsp::PI * highFreq / sampleRate);
     } else {
-        for (int ch = 0; ch < 2; ch++)
-            for (int s = 0; s < lpfStages_; s++)
-                lpf_[ch][s].setParams(Biquad::Type::LowPass, highFreq, 0.0f, 0.707f, sampleRate);
+        for (int s = 0; s < lpfStages_; s++)
+            lpf_[s].setParams(Biquad::Type::LowPass, highFreq, 0.0f, 0.707f, sampleRate);
     }
 }
 
-void Crossover::process(float* buffer, int numFrames, int numChannels) {
-    int channels = std::min(numChannels, 2);
+void Crossover::process(float* const* channels, int numFrames, int numChannels) {
+    int count = std::min(numChannels, 2);
 
     float extraGain = subGainLinear_ - 1.0f;
     if (std::abs(extraGain) < 0.001f) return;
 
-    for (int frame = 0; frame < numFrames; frame++) {
-        for (int ch = 0; ch < channels; ch++) {
-            int idx = frame * numChannels + ch;
-            float original = buffer[idx];
-
-            float hpfOut;
-            if (hpfSlope_ == 6) {
-                hpfOnePoleState_[ch] += hpfOnePoleCoeff_ * (original - hpfOnePoleState_[ch]);
-                hpfOut = original - hpfOnePoleState_[ch];
-            } else {
-                hpfOut = original;
-                for (int s = 0; s < hpfStages_; s++)
-                    hpfOut = hpf_[ch][s].process(hpfOut);
+    // sub_ = input - highpass(input)
+    for (int ch = 0; ch < count; ch++) {
+        const float* in = channels[ch];
+        float* sub = sub_[ch];
+        if (hpfSlope_ == 6) {
+            float state = hpfOnePoleState_[ch];
+            for (int frame = 0; frame < numFrames; frame++) {
+                state += hpfOnePoleCoeff_ * (in[frame] - state);
+                sub[frame] = in[frame] - (in[frame] - state);
             }
+            hpfOnePoleState_[ch] = state;
+        } else {
+            std::memcpy(sub, in, (size_t)numFrames * sizeof(float));
+        }
+    }
+    if (hpfSlope_ != 6) {
+        StereoBiquad::processCascade(hpf_, hpfStages_, sub_, numFrames, count);
+        for (int ch = 0; ch < count; ch++) {
+            const float* in = channels[ch];
+            float* sub = sub_[ch];
+            for (int frame = 0; frame < numFrames; frame++)
+                sub[frame] = in[frame] - sub[frame];
+        }
+    }
 
-            float sub = original - hpfOut;
-
-            if (lpfEnabled_) {
-                if (lpfSlope_ == 6) {
-                    lpfOnePoleState_[ch] += lpfOnePoleCoeff_ * (sub - lpfOnePoleState_[ch]);
-                    sub = lpfOnePoleState_[ch];
-                } else {
-                    for (int s = 0; s < lpfStages_; s++)
-                        sub = lpf_[ch][s].process(sub);
+    if (lpfEnabled_) {
+        if (lpfSlope_ == 6) {
+            for (int ch = 0; ch < count; ch++) {
+                float* sub = sub_[ch];
+                float state = lpfOnePoleState_[ch];
+                for (int frame = 0; frame < numFrames; frame++) {
+                    state += lpfOnePoleCoeff_ * (sub[frame] - state);
+                    sub[frame] = state;
                 }
+                lpfOnePoleState_[ch] = state;
             }
-
-            buffer[idx] = original + sub * extraGain;
+        } else {
+            StereoBiquad::processCascade(lpf_, lpfStages_, sub_, numFrames, count);
         }
     }
+
+    for (int ch = 0; ch < count; ch++) {
+        float* out = channels[ch];
+        const float* sub = sub_[ch];
+        for (int frame = 0; frame < numFrames; frame++)
+            out[frame] = out[frame] + sub[frame] * extraGain;
+    }
 }
 
 void Crossover::reset() {
+    for (int s = 0; s < MAX_STAGES; s++) {
+        hpf_[s].reset();
+        lpf_[s].reset();
+    }
     for (int ch = 0; ch < 2; ch++) {
-        for (int s = 0; s < MAX_STAGES; s++) {
-            hpf_[ch][s].reset();
-            lpf_[ch][s].reset();
-        }
         hpfOnePoleState_[ch] = 0.0f;
         lpfOnePoleState_[ch] = 0.0f;
     }
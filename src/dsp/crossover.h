@@ -1,6 +1,8 @@
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include "biquad.h"
+#include "scratch_arena.h"
 
 struct CrossoverParams {
     std::atomic<bool>  enabled{true};
@@ -12,17 +14,31 @@ struct CrossoverParams {
     std::atomic<float> subGainDb{6.0f};
 };
 
+struct CrossoverSettings {
+    bool  enabled = true;
+    bool  lpfEnabled = false;
+    float lowFreq = 30.0f;
+    float highFreq = 70.0f;
+    int   hpfSlope = 24;
+    int   lpfSlope = 24;
+    float subGainDb = 6.0f;
+    uint32_t version = 0;
+};
+
 class Crossover {
 public:
-    void updateParams(const CrossoverParams& params, float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void updateParams(const CrossoverSettings& settings, float sampleRate);
+    void process(float* const* channels, int numFrames, int numChannels);
     void reset();
 
 private:
     static constexpr int MAX_STAGES = 4;
 
-    Biquad hpf_[2][MAX_STAGES];
-    Biquad lpf_[2][MAX_STAGES];
+    StereoBiquad hpf_[MAX_STAGES];
+    StereoBiquad lpf_[MAX_STAGES];
+    // The sub band of the current block, per channel
+    float* sub_[2] = {};
 
     float hpfOnePoleState_[2] = {};
     float lpfOnePoleState_[2] = {};
@@ -41,4 +57,5 @@ private:
     int lastHpfSlope_ = 0;
     int lastLpfSlope_ = 0;
     float lastSampleRate_ = 0;
+    uint32_t lastVersion_ = ~0u;
 };
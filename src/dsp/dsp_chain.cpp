@@ -1,115 +1,223 @@
 #include "dsp_chain.h"
+#include "cpu_dispatch.h"
+#include "float_guard.h"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
 DSPChain::DSPChain(SharedParams& params) : params_(params) {}
 
-void DSPChain::updateTone(float sampleRate) {
-    const ToneParams& tp = params_.tone;
-    bool rateChanged = (sampleRate != lastToneSampleRate_);
+void DSPChain::prepare(float sampleRate, int maxBlockFrames, int numChannels) {
+    prepared_ = false;
+    preparedSampleRate_ = sampleRate;
+    tileFrames_ = std::min(TILE_FRAMES, maxBlockFrames);
+    maxChannels_ = numChannels;
+
+    arena_.reset();
+    prepareStages();
+    if (arena_.getNumBlocks() > 1) {
+        // First layout outgrew the arena; redo it in the merged block
+        arena_.reset();
+        prepareStages();
+    }
 
-    float bFreq = tp.bassFreq.load(std::memory_order_relaxed);
-    float bQ = tp.bassQ.load(std::memory_order_relaxed);
-    float bGain = tp.bassGainDb.load(std::memory_order_relaxed);
+    bassTone_.reset();
+    trebleTone_.reset();
+    lastToneSampleRate_ = 0;
+    linearSampleRate_ = 0;
+    lastMultibandVersion_ = ~0u;
+    prepared_ = true;
+}
 
-    if (rateChanged || bFreq != lastBassFreq_ || bQ != lastBassQ_ || bGain != lastBassGain_) {
-        for (int ch = 0; ch < 2; ch++)
-            bassTone_[ch].setParams(Biquad::Type::LowShelf, bFreq, bGain, bQ, sampleRate);
-        lastBassFreq_ = bFreq;
-        lastBassQ_ = bQ;
-        lastBassGain_ = bGain;
-    }
+void DSPChain::prepareStages() {
+    planar_ = arena_.allocateChannels(maxChannels_, (size_t)tileFrames_);
+    equalizer_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+    linearSection_.prepare(MAX_EQ_BANDS + 2, arena_);
+    crossover_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+    bandLimiter_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+    multiband_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+    compressor_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+    reverb_.prepare(preparedSampleRate_, tileFrames_, maxChannels_, arena_);
+}
 
-    float tFreq = tp.trebleFreq.load(std::memory_order_relaxed);
-    float tQ = tp.trebleQ.load(std::memory_order_relaxed);
-    float tGain = tp.trebleGainDb.load(std::memory_order_relaxed);
+void DSPChain::guardStage(int stage, float* const* channels, int numFrames, int numChannels) {
+    bool finite = true;
+    for (int ch = 0; ch < numChannels && finite; ch++)
+        finite = dsp::allFinite(channels[ch], (size_t)numFrames);
+    if (finite) return;
+
+    // One bad sample would stay in the stage's feedback state for good. Drop
+    // the block and start that stage over; the stages after it carry on.
+    for (int ch = 0; ch < numChannels; ch++)
+        std::memset(channels[ch], 0, (size_t)numFrames * sizeof(float));
+    switch (stage) {
+        case StageProfiler::EQ:
+            equalizer_.reset();
+            // The tone shelves share the minimum-phase EQ's cascade
+            if (!equalizer_.isLinearPhase()) { bassTone_.reset(); trebleTone_.reset(); }
+            break;
+        case StageProfiler::Tone:        bassTone_.reset(); trebleTone_.reset(); break;
+        case StageProfiler::Crossover:   crossover_.reset(); break;
+        case StageProfiler::BandLimiter: bandLimiter_.reset(); break;
+        case StageProfiler::Multiband:   multiband_.reset(); break;
+        case StageProfiler::Compressor:  compressor_.reset(); break;
+        case StageProfiler::Reverb:      reverb_.reset(); break;
+        default: break;
+    }
+    nonFiniteResets_.store(nonFiniteResets_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
 
-    if (rateChanged || tFreq != lastTrebleFreq_ || tQ != lastTrebleQ_ || tGain != lastTrebleGain_) {
-        for (int ch = 0; ch < 2; ch++)
-            trebleTone_[ch].setParams(Biquad::Type::HighShelf, tFreq, tGain, tQ, sampleRate);
-        lastTrebleFreq_ = tFreq;
-        lastTrebleQ_ = tQ;
-        lastTrebleGain_ = tGain;
+void DSPChain::fillTelemetry(Telemetry& telemetry) const {
+    telemetry.compressorGainReductionDb = compressor_.getGainReduction();
+    telemetry.nonFiniteResets = nonFiniteResets_.load(std::memory_order_relaxed);
+
+    telemetry.numBands = std::min(multiband_.getNumBands(), Telemetry::MAX_BANDS);
+    for (int b = 0; b < telemetry.numBands; b++) {
+        const MultibandBand& band = multiband_.getBand(b);
+        telemetry.bandLowFreq[b] = band.lowFreq;
+        telemetry.bandHighFreq[b] = band.highFreq;
+        telemetry.bandEnergy[b] = band.energy;
+        telemetry.bandGainReductionDb[b] = multiband_.getBandGainReduction(b);
     }
+}
 
+void DSPChain::updateTone(const ToneSettings& tone, float sampleRate) {
+    if (tone.version == lastToneVersion_ && sampleRate == lastToneSampleRate_) return;
+    lastToneVersion_ = tone.version;
     lastToneSampleRate_ = sampleRate;
+
+    bassTone_.setParams(Biquad::Type::LowShelf, tone.bassFreq, tone.bassGainDb, tone.bassQ, sampleRate);
+    trebleTone_.setParams(Biquad::Type::HighShelf, tone.trebleFreq, tone.trebleGainDb, tone.trebleQ, sampleRate);
+}
+
+void DSPChain::updateLinearSection(const ParamSnapshot& snap, float sampleRate) {
+    if (snap.eq.version == linearEqVersion_ && snap.tone.version == linearToneVersion_ &&
+        sampleRate == linearSampleRate_) return;
+    linearEqVersion_ = snap.eq.version;
+    linearToneVersion_ = snap.tone.version;
+    linearSampleRate_ = sampleRate;
+
+    linearSection_.clear();
+    equalizer_.appendSections(linearSection_);
+    if (snap.tone.bassEnabled)   linearSection_.append(bassTone_);
+    if (snap.tone.trebleEnabled) linearSection_.append(trebleTone_);
+}
+
+void DSPChain::updateMultiband(const MultibandSettings& settings) {
+    if (settings.version == lastMultibandVersion_) return;
+    lastMultibandVersion_ = settings.version;
+
+    // The stage's analysis thread only runs while the stage does
+    multiband_.setAnalysisRunning(settings.enabled);
+    if (!settings.enabled) return;
+
+    multiband_.setAutoBalance(settings.autoBalance);
+    multiband_.setAutoBalanceSpeed(settings.autoBalanceSpeed);
+    multiband_.setGlobalCompression(settings.compression);
+    multiband_.setOutputGain(settings.outputGain);
+    multiband_.setExciterAmount(settings.exciterAmount);
+    multiband_.setSubBassBoost(settings.subBassBoost);
+    multiband_.setSubBassRange(settings.subBassLowFreq, settings.subBassHighFreq);
+    multiband_.setMultirate(settings.multirate);
 }
 
 void DSPChain::process(float* buffer, int numFrames, int numChannels, float sampleRate) {
-    if (params_.bypassAll.load(std::memory_order_relaxed))
+    const ParamSnapshot& snap = params_.acquireSnapshot();
+    if (snap.bypassAll)
+        return;
+    if (!prepared_ || sampleRate != preparedSampleRate_ || numChannels > maxChannels_)
         return;
 
-    if (params_.eq.enabled.load(std::memory_order_relaxed)) {
-        equalizer_.updateParams(params_.eq, sampleRate);
-        equalizer_.process(buffer, numFrames, numChannels);
+    for (int offset = 0; offset < numFrames; offset += tileFrames_) {
+        int frames = std::min(tileFrames_, numFrames - offset);
+        processTile(buffer + (size_t)offset * numChannels, frames, numChannels, sampleRate, snap);
     }
 
-    updateTone(sampleRate);
-    bool bassOn = params_.tone.bassEnabled.load(std::memory_order_relaxed);
-    bool trebleOn = params_.tone.trebleEnabled.load(std::memory_order_relaxed);
-
-    if (bassOn || trebleOn) {
-        int channels = std::min(numChannels, 2);
-        for (int frame = 0; frame < numFrames; frame++) {
-            for (int ch = 0; ch < channels; ch++) {
-                int idx = frame * numChannels + ch;
-                float sample = buffer[idx];
-                if (bassOn)   sample = bassTone_[ch].process(sample);
-                if (trebleOn) sample = trebleTone_[ch].process(sample);
-                buffer[idx] = sample;
-            }
+    multibandLatency_.store(snap.multiband.enabled ? multiband_.getLatencySamples() : 0,
+                            std::memory_order_relaxed);
+}
+
+void DSPChain::processTile(float* buffer, int numFrames, int numChannels, float sampleRate,
+                           const ParamSnapshot& snap) {
+    DSP_PROFILE_BLOCK(profiler_, numFrames, sampleRate);
+
+    // A NaN from the device would otherwise be blamed on the first stage
+    if (!dsp::allFinite(buffer, (size_t)numFrames * numChannels))
+        std::memset(buffer, 0, (size_t)numFrames * numChannels * sizeof(float));
+
+    const dsp::Kernels& k = dsp::kernels();
+    float* const* channels = planar_;
+    k.deinterleave(buffer, channels, numFrames, numChannels);
+
+    // In minimum-phase mode the EQ bands and the tone shelves are all plain
+    // biquads on the same samples, so they run as one cascade after the
+    // preamp; the profiler and guard count that pass as the EQ stage
+    bool toneFused = false;
+    if (snap.eq.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::EQ);
+        equalizer_.updateParams(snap.eq, sampleRate);
+        if (equalizer_.isLinearPhase()) {
+            equalizer_.process(channels, numFrames, numChannels);
+        } else {
+            updateTone(snap.tone, sampleRate);
+            updateLinearSection(snap, sampleRate);
+            equalizer_.applyPreamp(channels, numFrames, numChannels);
+            linearSection_.process(channels, numFrames, numChannels);
+            toneFused = true;
         }
+        guardStage(StageProfiler::EQ, channels, numFrames, numChannels);
+    }
+
+    if (!toneFused) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::Tone);
+        updateTone(snap.tone, sampleRate);
+
+        if (snap.tone.bassEnabled)   bassTone_.processBlock(channels, numFrames, numChannels);
+        if (snap.tone.trebleEnabled) trebleTone_.processBlock(channels, numFrames, numChannels);
+        if (snap.tone.bassEnabled || snap.tone.trebleEnabled)
+            guardStage(StageProfiler::Tone, channels, numFrames, numChannels);
     }
 
-    if (params_.crossover.enabled.load(std::memory_order_relaxed)) {
-        crossover_.updateParams(params_.crossover, sampleRate);
-        crossover_.process(buffer, numFrames, numChannels);
+    if (snap.crossover.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::Crossover);
+        crossover_.updateParams(snap.crossover, sampleRate);
+        crossover_.process(channels, numFrames, numChannels);
+        guardStage(StageProfiler::Crossover, channels, numFrames, numChannels);
     }
 
-    if (params_.bandLimiter.enabled.load(std::memory_order_relaxed)) {
-        bandLimiter_.updateParams(params_.bandLimiter, sampleRate);
-        bandLimiter_.process(buffer, numFrames, numChannels);
+    if (snap.bandLimiter.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::BandLimiter);
+        bandLimiter_.updateParams(snap.bandLimiter, sampleRate);
+        bandLimiter_.process(channels, numFrames, numChannels);
+        guardStage(StageProfiler::BandLimiter, channels, numFrames, numChannels);
     }
 
-    if (params_.multiband.enabled.load(std::memory_order_relaxed)) {
-        multiband_.setAutoBalance(params_.multiband.autoBalance.load(std::memory_order_relaxed));
-        multiband_.setAutoBalanceSpeed(params_.multiband.autoBalanceSpeed.load(std::memory_order_relaxed));
-        multiband_.setGlobalCompression(params_.multiband.compression.load(std::memory_order_relaxed));
-        multiband_.setOutputGain(params_.multiband.outputGain.load(std::memory_order_relaxed));
-        multiband_.setSubBassBoost(params_.multiband.subBassBoost.load(std::memory_order_relaxed));
-        multiband_.setSubBassRange(
-            params_.multiband.subBassLowFreq.load(std::memory_order_relaxed),
-            params_.multiband.subBassHighFreq.load(std::memory_order_relaxed)
-        );
-        multiband_.process(buffer, numFrames, numChannels, sampleRate);
+    updateMultiband(snap.multiband);
+    if (snap.multiband.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::Multiband);
+        multiband_.process(channels, numFrames, numChannels, sampleRate);
+        guardStage(StageProfiler::Multiband, channels, numFrames, numChannels);
     }
 
-    if (params_.compressor.enabled.load(std::memory_order_relaxed)) {
-        compressor_.updateParams(params_.compressor, sampleRate);
-        compressor_.process(buffer, numFrames, numChannels);
+    if (snap.compressor.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::Compressor);
+        compressor_.updateParams(snap.compressor, sampleRate);
+        compressor_.process(channels, numFrames, numChannels);
+        guardStage(StageProfiler::Compressor, channels, numFrames, numChannels);
     }
 
-    if (params_.reverb.enabled.load(std::memory_order_relaxed)) {
-        if (!reverbInitialized_) {
-            reverb_.init(sampleRate);
-            reverbInitialized_ = true;
-        }
-        reverb_.updateParams(params_.reverb);
-        reverb_.process(buffer, numFrames, numChannels);
+    if (snap.reverb.enabled) {
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::Reverb);
+        reverb_.updateParams(snap.reverb);
+        reverb_.process(channels, numFrames, numChannels);
+        guardStage(StageProfiler::Reverb, channels, numFrames, numChannels);
     }
 
     {
-        constexpr float threshold = 0.9f;
-        constexpr float headroom = 1.0f - threshold;
-        int totalSamples = numFrames * numChannels;
-        for (int i = 0; i < totalSamples; i++) {
-            float x = buffer[i];
-            float ax = std::abs(x);
-            if (ax > threshold) {
-                float sign = (x >= 0.0f) ? 1.0f : -1.0f;
-                float over = (ax - threshold) / headroom;
-                buffer[i] = sign * (threshold + headroom * std::tanh(over));
-            }
-        }
+        DSP_PROFILE_SCOPE(profiler_, StageProfiler::SoftClip);
+        for (int ch = 0; ch < numChannels; ch++)
+            k.softClip(channels[ch], (size_t)numFrames, 0.9f);
     }
+
+    k.interleave(channels, buffer, numFrames, numChannels);
 }
@@ -6,20 +6,67 @@
 #include "band_limiter.h"
 #include "multiband_processor.h"
 #include "biquad.h"
+#include "scratch_arena.h"
+#include "stage_profiler.h"
 #include "common/params.h"
+#include "common/telemetry.h"
 
 class DSPChain {
 public:
     DSPChain(SharedParams& params);
 
+    // Frames every stage runs on before the next stage starts. A tile's
+    // planar samples and each stage's scratch for it stay in L1/L2, where
+    // whole device blocks (up to 16384 frames) would be evicted by each stage.
+    static constexpr int TILE_FRAMES = 256;
+
+    // Sizes every stage and lays out all run-time buffers in one arena. Must
+    // be called before the first process() and never concurrently with it.
+    // Afterwards process() does not allocate, and a rate or channel count
+    // other than the prepared one passes audio through untouched.
+    //
+    // process() takes interleaved audio of any length, as the devices deliver
+    // it, and cuts it into tiles of TILE_FRAMES (maxBlockFrames, if smaller);
+    // a block that is not a whole number of tiles ends in a shorter one, so
+    // no latency is added. Each tile is split into planar channel arrays,
+    // runs through every stage, and is interleaved back in place.
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels);
+    bool isPrepared() const { return prepared_; }
+
+    // Picks up the latest published ParamSnapshot once per call.
     void process(float* buffer, int numFrames, int numChannels, float sampleRate);
 
     Compressor& getCompressor() { return compressor_; }
     Equalizer&  getEqualizer()  { return equalizer_; }
     MultibandProcessor& getMultiband() { return multiband_; }
+    const StageProfiler& getProfiler() const { return profiler_; }
+    StageProfiler& getProfiler() { return profiler_; }
+
+    // Audio thread, after process(): the chain's part of the meter values
+    void fillTelemetry(Telemetry& telemetry) const;
+
+    // Delay the chain adds on top of the device buffers, in samples.
+    int getLatencySamples() const {
+        return equalizer_.getLatencySamples() + multibandLatency_.load(std::memory_order_relaxed);
+    }
+
+    // Offline use, same thread as process(): blocks until filters built in the
+    // background for the current parameters are in use, so the output does
+    // not depend on thread scheduling.
+    void waitForDesigns() { equalizer_.waitForDesign(); }
+
+    // Offline use, before prepare(): the multiband analyzer runs inline
+    // instead of on its own thread, for the same reason.
+    void setBackgroundAnalysis(bool enable) { multiband_.setBackgroundAnalysis(enable); }
 
 private:
-    void updateTone(float sampleRate);
+    void prepareStages();
+    void processTile(float* buffer, int numFrames, int numChannels, float sampleRate,
+                     const ParamSnapshot& snap);
+    void updateTone(const ToneSettings& tone, float sampleRate);
+    void updateLinearSection(const ParamSnapshot& snap, float sampleRate);
+    void updateMultiband(const MultibandSettings& settings);
+    void guardStage(int stage, float* const* channels, int numFrames, int numChannels);
 
     SharedParams& params_;
     Compressor compressor_;
@@ -28,11 +75,29 @@ private:
     Crossover  crossover_;
     BandLimiter bandLimiter_;
     MultibandProcessor multiband_;
-    bool       reverbInitialized_ = false;
 
-    Biquad bassTone_[2];
-    Biquad trebleTone_[2];
-    float lastBassFreq_ = 0, lastBassQ_ = 0, lastBassGain_ = -999;
-    float lastTrebleFreq_ = 0, lastTrebleQ_ = 0, lastTrebleGain_ = -999;
+    StageProfiler profiler_;
+
+    ScratchArena arena_;
+    // One tile per channel
+    float** planar_ = nullptr;
+    bool  prepared_ = false;
+    float preparedSampleRate_ = 0.0f;
+    int   tileFrames_ = 0;
+    int   maxChannels_ = 0;
+
+    StereoBiquad bassTone_;
+    StereoBiquad trebleTone_;
+    uint32_t lastToneVersion_ = ~0u;
     float lastToneSampleRate_ = 0;
+    // Minimum-phase EQ bands followed by the enabled tone shelves, run as one
+    // cascade; rebuilt when either set of parameters changes
+    BiquadCascade linearSection_;
+    uint32_t linearEqVersion_ = ~0u;
+    uint32_t linearToneVersion_ = ~0u;
+    float linearSampleRate_ = 0;
+    uint32_t lastMultibandVersion_ = ~0u;
+    std::atomic<int> multibandLatency_{0};
+    // Stages restarted after putting out NaN or infinity
+    std::atomic<uint32_t> nonFiniteResets_{0};
 };
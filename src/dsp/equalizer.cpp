@@ -1,6 +1,8 @@
 #include "equalizer.h"
+#include "cpu_dispatch.h"
 #include "dsp_common.h"
 #include <cmath>
+#include <algorithm>
 
 Biquad::Type Equalizer::mapFilterType(int configType) {
     switch (configType) {
@@ -14,57 +16,120 @@ Biquad::Type Equalizer::mapFilterType(int configType) {
     }
 }
 
-void Equalizer::updateParams(const EQParams& params, float sampleRate) {
-    int nBands = params.numBands();
+void Equalizer::prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena) {
+    // Reserve the band limit up front so updateParams never reallocates
+    filters_.reserve(MAX_EQ_BANDS);
+    activeBands_.reserve(MAX_EQ_BANDS);
+    activeBands_.clear();
+    plan_.prepare(MAX_EQ_BANDS, arena);
+    linearPhase_.prepare(sampleRate, maxBlockFrames, numChannels, arena);
+    reset();
+    lastSampleRate_ = 0.0f;
+    lastVersion_ = ~0u;
+}
+
+static bool sameBand(const EQBandSettings& a, const EQBandSettings& b) {
+    return a.type == b.type && a.freq == b.freq && a.q == b.q && a.gainDb == b.gainDb;
+}
+
+void Equalizer::updateParams(const EQSettings& settings, float sampleRate) {
+    static_assert(MAX_EQ_BANDS <= 64, "one dirty bit per band");
+
     bool rateChanged = (sampleRate != lastSampleRate_);
+    if (settings.version == lastVersion_ && !rateChanged && initialized_) return;
+    lastVersion_ = settings.version;
+
+    if (!initialized_ || rateChanged) {
+        for (auto& applied : applied_) applied.type = -1;
+    }
 
+    int nBands = std::min(settings.numBands, MAX_EQ_BANDS);
+    bool layoutChanged = !initialized_ || nBands != numBands_;
     if (nBands != numBands_) {
-        filtersL_.resize(nBands);
-        filtersR_.resize(nBands);
-        lastGainDb_.resize(nBands, -999.0f);
+        // Within the capacity reserved in prepare(), so no allocation here.
+        // Bands dropped now are designed afresh if they come back.
+        for (int band = nBands; band < numBands_; band++) applied_[band].type = -1;
+        filters_.resize(nBands);
         numBands_ = nBands;
-        initialized_ = false;
     }
 
-    float preampDb = params.preamp.load(std::memory_order_relaxed);
-    preampLinear_ = dsp::dbToLinear(preampDb);
+    float preampLinear = dsp::dbToLinear(settings.preamp);
+    bool preampChanged = preampLinear != preampLinear_;
+    preampLinear_ = preampLinear;
 
+    // Only the bands whose type, frequency, Q or gain moved are redesigned
+    uint64_t dirty = 0;
     for (int band = 0; band < nBands; band++) {
-        const BandParam& bp = params.bands[band];
-        float gainDb = bp.gainDb.load(std::memory_order_relaxed);
-
-        if (!initialized_ || rateChanged || gainDb != lastGainDb_[band]) {
-            Biquad::Type bqType = mapFilterType(bp.type);
-            filtersL_[band].setParams(bqType, bp.freq, gainDb, bp.q, sampleRate);
-            filtersR_[band].setParams(bqType, bp.freq, gainDb, bp.q, sampleRate);
-            lastGainDb_[band] = gainDb;
-        }
+        if (!sameBand(settings.bands[band], applied_[band])) dirty |= 1ull << band;
+    }
+    for (int band = 0; band < nBands; band++) {
+        if (!(dirty & (1ull << band))) continue;
+        const EQBandSettings& bp = settings.bands[band];
+        filters_[band].setParams(mapFilterType(bp.type), bp.freq, bp.gainDb, bp.q, sampleRate);
+        applied_[band] = bp;
     }
 
     lastSampleRate_ = sampleRate;
     initialized_ = true;
-}
-
-void Equalizer::process(float* buffer, int numFrames, int numChannels) {
-    int channels = (numChannels > 2) ? 2 : numChannels;
 
-    for (int frame = 0; frame < numFrames; frame++) {
-        for (int ch = 0; ch < channels; ch++) {
-            int idx = frame * numChannels + ch;
-            float sample = buffer[idx] * preampLinear_;
+    if (settings.linearPhase != linearPhaseEnabled_) {
+        linearPhaseEnabled_ = settings.linearPhase;
+        if (linearPhaseEnabled_) linearPhase_.reset();
+        latencySamples_.store(linearPhaseEnabled_ ? LinearPhaseEQ::LATENCY_SAMPLES : 0,
+                              std::memory_order_relaxed);
+    } else if (!dirty && !preampChanged && !layoutChanged) {
+        // Only the enable switch moved: the plan and FIR still hold
+        return;
+    }
 
-            auto& filters = (ch == 0) ? filtersL_ : filtersR_;
-            for (int band = 0; band < numBands_; band++) {
-                sample = filters[band].process(sample);
-            }
+    compile();
+    // The FIR is derived from the biquads above, so it follows every change
+    if (linearPhaseEnabled_)
+        linearPhase_.requestDesign(filters_.data(), numBands_, preampLinear_);
+}
 
-            buffer[idx] = sample;
+// Presets and slider drags leave plenty of bands at 0 dB; those are dropped
+// rather than run as pass-through sections. Runs on the audio thread between
+// blocks, so the new plan simply replaces the old one.
+void Equalizer::compile() {
+    activeBands_.clear();
+    for (int band = 0; band < numBands_; band++) {
+        if (Biquad::isIdentity(filters_[band].getCoeffs())) {
+            // Where a running identity section's state would have settled
+            filters_[band].reset();
+            continue;
         }
+        activeBands_.push_back(band);
+    }
+
+    plan_.clear();
+    appendSections(plan_);
+}
+
+void Equalizer::process(float* const* channels, int numFrames, int numChannels) {
+    if (linearPhaseEnabled_) {
+        linearPhase_.process(channels, numFrames, numChannels);
+        return;
     }
+
+    applyPreamp(channels, numFrames, numChannels);
+    plan_.process(channels, numFrames, numChannels);
+}
+
+void Equalizer::applyPreamp(float* const* channels, int numFrames, int numChannels) {
+    if (!activeBands_.empty() || preampLinear_ == 1.0f) return;
+    const dsp::Kernels& k = dsp::kernels();
+    for (int ch = 0; ch < std::min(numChannels, 2); ch++)
+        k.applyGain(channels[ch], (size_t)numFrames, preampLinear_);
+}
+
+void Equalizer::appendSections(BiquadCascade& cascade) {
+    for (size_t i = 0; i < activeBands_.size(); i++)
+        cascade.append(filters_[activeBands_[i]], i == 0 ? preampLinear_ : 1.0f);
 }
 
 void Equalizer::reset() {
-    for (auto& f : filtersL_) f.reset();
-    for (auto& f : filtersR_) f.reset();
+    for (auto& f : filters_) f.reset();
+    linearPhase_.reset();
     initialized_ = false;
 }
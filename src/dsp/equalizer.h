@@ -1,24 +1,52 @@
 #pragma once
 #include "biquad.h"
+#include "linear_phase_eq.h"
+#include "scratch_arena.h"
 #include "common/params.h"
+#include <atomic>
 #include <vector>
 
 class Equalizer {
 public:
     Equalizer() = default;
 
-    void updateParams(const EQParams& params, float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void updateParams(const EQSettings& settings, float sampleRate);
+    void process(float* const* channels, int numFrames, int numChannels);
     void reset();
 
+    // Minimum-phase mode, for running the bands in a cascade shared with
+    // other filters: process() is applyPreamp() followed by the sections
+    // appended here, which stay valid until the next updateParams(). The
+    // preamp rides on the first section; applyPreamp() only does anything
+    // when there is none.
+    bool isLinearPhase() const { return linearPhaseEnabled_; }
+    void applyPreamp(float* const* channels, int numFrames, int numChannels);
+    void appendSections(BiquadCascade& cascade);
+    // Offline renders: see LinearPhaseEQ::waitForDesign
+    void waitForDesign() { if (linearPhaseEnabled_) linearPhase_.waitForDesign(); }
+
+    // Samples of delay added by the linear-phase mode, 0 in minimum-phase mode.
+    int getLatencySamples() const { return latencySamples_.load(std::memory_order_relaxed); }
+
 private:
     static Biquad::Type mapFilterType(int configType);
+    void compile();
 
-    std::vector<Biquad> filtersL_;
-    std::vector<Biquad> filtersR_;
-    std::vector<float> lastGainDb_;
+    std::vector<StereoBiquad> filters_;
+    // Settings each filter was last designed from; type -1 forces a redesign
+    EQBandSettings applied_[MAX_EQ_BANDS];
+    // Execution plan built by compile(): the bands that are not identity
+    // sections, in order, with the preamp folded into the first
+    std::vector<int> activeBands_;
+    BiquadCascade plan_;
     float lastSampleRate_ = 0.0f;
+    uint32_t lastVersion_ = ~0u;
     float preampLinear_ = 1.0f;
     int numBands_ = 0;
     bool initialized_ = false;
+
+    LinearPhaseEQ linearPhase_;
+    bool linearPhaseEnabled_ = false;
+    std::atomic<int> latencySamples_{0};
 };
@@ -1,6 +1,7 @@
 #include "exciter.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 
 Exciter::Exciter() {
     init(48000.0f);
@@ -14,47 +15,42 @@ void Exciter::init(float sampleRate) {
 
 void Exciter::setFrequency(float freq) {
     frequency_ = std::max(1000.0f, std::min(freq, 16000.0f));
-    hpfL_.setParams(Biquad::Type::HighPass, frequency_, 0.0f, 0.707f, sampleRate_);
-    hpfR_.setParams(Biquad::Type::HighPass, frequency_, 0.0f, 0.707f, sampleRate_);
+    hpf_.setParams(Biquad::Type::HighPass, frequency_, 0.0f, 0.707f, sampleRate_);
 }
 
-void Exciter::process(float* buffer, int numFrames, int numChannels) {
+float Exciter::processSample(float high) const {
+    float excited = high;
+    if (harmonicOrder_ >= 2) {
+        excited = std::tanh(high * 2.0f) * 0.5f;
+    }
+    if (harmonicOrder_ >= 3) {
+        float squared = high * high;
+        excited += squared * high * 0.3f;
+    }
+    return excited;
+}
+
+void Exciter::prepare(int maxBlockFrames, ScratchArena& arena) {
+    for (auto& buf : high_)
+        buf = arena.allocate<float>((size_t)maxBlockFrames);
+}
+
+void Exciter::process(float* const* channels, int numFrames, int numChannels) {
     if (amount_ < 0.001f) return;
+    int count = std::min(numChannels, 2);
+
+    for (int ch = 0; ch < count; ch++)
+        std::memcpy(high_[ch], channels[ch], (size_t)numFrames * sizeof(float));
+    hpf_.processBlock(high_, numFrames, count);
 
-    for (int i = 0; i < numFrames; i++) {
-        float dryL = buffer[i * numChannels];
-        float highL = hpfL_.process(dryL);
-
-        float excitedL = highL;
-        if (harmonicOrder_ >= 2) {
-            excitedL = std::tanh(highL * 2.0f) * 0.5f;
-        }
-        if (harmonicOrder_ >= 3) {
-            float squared = highL * highL;
-            excitedL += squared * highL * 0.3f;
-        }
-
-        buffer[i * numChannels] = dryL + excitedL * amount_;
-
-        if (numChannels > 1) {
-            float dryR = buffer[i * numChannels + 1];
-            float highR = hpfR_.process(dryR);
-
-            float excitedR = highR;
-            if (harmonicOrder_ >= 2) {
-                excitedR = std::tanh(highR * 2.0f) * 0.5f;
-            }
-            if (harmonicOrder_ >= 3) {
-                float squared = highR * highR;
-                excitedR += squared * highR * 0.3f;
-            }
-
-            buffer[i * numChannels + 1] = dryR + excitedR * amount_;
-        }
+    for (int ch = 0; ch < count; ch++) {
+        float* samples = channels[ch];
+        const float* high = high_[ch];
+        for (int i = 0; i < numFrames; i++)
+            samples[i] = samples[i] + processSample(high[i]) * amount_;
     }
 }
 
 void Exciter::reset() {
-    hpfL_.reset();
-    hpfR_.reset();
+    hpf_.reset();
 }
@@ -1,12 +1,14 @@
 #pragma once
 #include "biquad.h"
+#include "scratch_arena.h"
 
 class Exciter {
 public:
     Exciter();
 
     void init(float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(int maxBlockFrames, ScratchArena& arena);
+    void process(float* const* channels, int numFrames, int numChannels);
 
     void setAmount(float amount) { amount_ = amount; }
     void setFrequency(float freq);
@@ -15,9 +17,10 @@ public:
     void reset();
 
 private:
-    float processSample(float input);
+    float processSample(float high) const;
 
-    Biquad hpfL_, hpfR_;
+    StereoBiquad hpf_;
+    float* high_[2] = {};
     float amount_ = 0.3f;
     float frequency_ = 4000.0f;
     float sampleRate_ = 48000.0f;
@@ -0,0 +1,139 @@
+#include "fft.h"
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+RealFFT::RealFFT(int size) : size_(size), half_(size / 2) {
+    int bits = 0;
+    while ((1 << bits) < half_) bits++;
+
+    bitRev_.resize(half_);
+    for (int i = 0; i < half_; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        bitRev_[i] = r;
+    }
+
+    twiddles_.resize(half_);
+    for (int j = 0; j < half_ / 2; j++) {
+        double phase = -2.0 * 3.14159265358979323846 * j / half_;
+        twiddles_[2 * j]     = (float)std::cos(phase);
+        twiddles_[2 * j + 1] = (float)std::sin(phase);
+    }
+
+    realTwiddles_.resize(2 * (half_ / 2 + 1));
+    for (int k = 0; k <= half_ / 2; k++) {
+        double phase = -2.0 * 3.14159265358979323846 * k / size_;
+        realTwiddles_[2 * k]     = (float)std::cos(phase);
+        realTwiddles_[2 * k + 1] = (float)std::sin(phase);
+    }
+}
+
+std::shared_ptr<const RealFFT> RealFFT::get(int size) {
+    static std::mutex mutex;
+    static std::vector<std::pair<int, std::shared_ptr<const RealFFT>>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : cache) {
+        if (entry.first == size) return entry.second;
+    }
+    auto fft = std::make_shared<const RealFFT>(size);
+    cache.emplace_back(size, fft);
+    return fft;
+}
+
+void RealFFT::complexFFT(float* data, bool inverse) const {
+    for (int i = 0; i < half_; i++) {
+        int j = bitRev_[i];
+        if (j > i) {
+            std::swap(data[2 * i], data[2 * j]);
+            std::swap(data[2 * i + 1], data[2 * j + 1]);
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (int len = 2; len <= half_; len <<= 1) {
+        int halfLen = len >> 1;
+        int step = half_ / len;
+        for (int i = 0; i < half_; i += len) {
+            for (int j = 0; j < halfLen; j++) {
+                float wr = twiddles_[2 * j * step];
+                float wi = sign * twiddles_[2 * j * step + 1];
+
+                float* u = data + 2 * (i + j);
+                float* v = data + 2 * (i + j + halfLen);
+                float vr = v[0] * wr - v[1] * wi;
+                float vi = v[0] * wi + v[1] * wr;
+
+                v[0] = u[0] - vr;
+                v[1] = u[1] - vi;
+                u[0] += vr;
+                u[1] += vi;
+            }
+        }
+    }
+}
+
+void RealFFT::forward(const float* in, float* out) const {
+    // Pack even/odd samples as one complex sequence of half the length
+    std::memcpy(out, in, size_ * sizeof(float));
+    complexFFT(out, false);
+
+    float z0r = out[0], z0i = out[1];
+    out[0] = z0r + z0i;
+    out[1] = 0.0f;
+    out[size_] = z0r - z0i;
+    out[size_ + 1] = 0.0f;
+
+    for (int k = 1; k <= half_ / 2; k++) {
+        int m = half_ - k;
+        float ar = out[2 * k], ai = out[2 * k + 1];
+        float br = out[2 * m], bi = out[2 * m + 1];
+
+        // E = (Z[k] + conj(Z[m])) / 2, O = (Z[k] - conj(Z[m])) / 2i
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        float or_ = 0.5f * (ai + bi), oi = -0.5f * (ar - br);
+
+        float wr = realTwiddles_[2 * k], wi = realTwiddles_[2 * k + 1];
+        float tr = wr * or_ - wi * oi;
+        float ti = wr * oi + wi * or_;
+
+        out[2 * k]     = er + tr;
+        out[2 * k + 1] = ei + ti;
+        out[2 * m]     = er - tr;
+        out[2 * m + 1] = -(ei - ti);
+    }
+}
+
+void RealFFT::inverse(const float* in, float* out) const {
+    float x0 = in[0], xn = in[size_];
+    out[0] = 0.5f * (x0 + xn);
+    out[1] = 0.5f * (x0 - xn);
+
+    for (int k = 1; k <= half_ / 2; k++) {
+        int m = half_ - k;
+        float ar = in[2 * k], ai = in[2 * k + 1];
+        float br = in[2 * m], bi = in[2 * m + 1];
+
+        // E = (X[k] + conj(X[m])) / 2, O = (X[k] - conj(X[m])) * conj(w) / 2
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        float dr = 0.5f * (ar - br), di = 0.5f * (ai + bi);
+
+        float wr = realTwiddles_[2 * k], wi = -realTwiddles_[2 * k + 1];
+        float or_ = dr * wr - di * wi;
+        float oi = dr * wi + di * wr;
+
+        // Z[k] = E + iO, Z[m] = conj(E) + i conj(O)
+        out[2 * k]     = er - oi;
+        out[2 * k + 1] = ei + or_;
+        out[2 * m]     = er + oi;
+        out[2 * m + 1] = or_ - ei;
+    }
+
+    complexFFT(out, true);
+
+    float scale = 1.0f / half_;
+    for (int i = 0; i < size_; i++) out[i] *= scale;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <memory>
+
+// Radix-2 real-input FFT. Twiddles and the bit-reversal table are built once
+// per size and shared by every user through get().
+class RealFFT {
+public:
+    explicit RealFFT(int size);
+
+    static std::shared_ptr<const RealFFT> get(int size);
+
+    int size() const { return size_; }
+
+    // in: size real samples. out: size/2 + 1 complex bins as interleaved
+    // re/im pairs (size + 2 floats). Unnormalized.
+    void forward(const float* in, float* out) const;
+
+    // Inverse of forward(): size + 2 floats of spectrum in, size real samples
+    // out, scaled so that inverse(forward(x)) == x.
+    void inverse(const float* in, float* out) const;
+
+private:
+    void complexFFT(float* data, bool inverse) const;
+
+    int size_;
+    int half_;
+    std::vector<int> bitRev_;
+    std::vector<float> twiddles_;      // e^{-2*pi*i*j/half}, j < half/2
+    std::vector<float> realTwiddles_;  // e^{-2*pi*i*k/size}, k <= half/2
+};
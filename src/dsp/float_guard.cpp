@@ -0,0 +1,72 @@
+#include "float_guard.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GUARD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GUARD_NEON 1
+#endif
+
+namespace dsp {
+
+namespace {
+constexpr uint32_t EXPONENT_MASK = 0x7F800000u;   // all ones: NaN or infinity
+
+#if defined(GUARD_SSE)
+constexpr uint32_t MXCSR_DAZ = 1u << 6;
+constexpr uint32_t MXCSR_FTZ = 1u << 15;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+constexpr uint64_t FPCR_FZ = 1ull << 24;
+#endif
+} // namespace
+
+ScopedFlushDenormals::ScopedFlushDenormals() {
+#if defined(GUARD_SSE)
+    saved_ = _mm_getcsr();
+    _mm_setcsr((unsigned)saved_ | MXCSR_DAZ | MXCSR_FTZ);
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(saved_));
+    uint64_t fpcr = saved_ | FPCR_FZ;
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#endif
+}
+
+ScopedFlushDenormals::~ScopedFlushDenormals() {
+#if defined(GUARD_SSE)
+    _mm_setcsr((unsigned)saved_);
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(saved_));
+#endif
+}
+
+bool allFinite(const float* buffer, size_t count) {
+    size_t i = 0;
+#if defined(GUARD_SSE)
+    const __m128i mask = _mm_set1_epi32((int)EXPONENT_MASK);
+    __m128i bad = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i exponent = _mm_and_si128(_mm_loadu_si128((const __m128i*)(buffer + i)), mask);
+        bad = _mm_or_si128(bad, _mm_cmpeq_epi32(exponent, mask));
+    }
+    if (_mm_movemask_epi8(bad)) return false;
+#elif defined(GUARD_NEON)
+    const uint32x4_t mask = vdupq_n_u32(EXPONENT_MASK);
+    uint32x4_t bad = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t exponent = vandq_u32(vreinterpretq_u32_f32(vld1q_f32(buffer + i)), mask);
+        bad = vorrq_u32(bad, vceqq_u32(exponent, mask));
+    }
+    uint32x2_t folded = vorr_u32(vget_low_u32(bad), vget_high_u32(bad));
+    if (vget_lane_u32(vpmax_u32(folded, folded), 0)) return false;
+#endif
+    for (; i < count; i++) {
+        uint32_t bits;
+        std::memcpy(&bits, buffer + i, sizeof(bits));
+        if ((bits & EXPONENT_MASK) == EXPONENT_MASK) return false;
+    }
+    return true;
+}
+
+} // namespace dsp
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace dsp {
+
+// Turns on flush-to-zero and denormals-are-zero (FZ on ARM) for the calling
+// thread and restores the previous mode when it goes out of scope. Decaying
+// filter and reverb state then reaches zero instead of crawling through
+// subnormals, which cost up to a hundred times more per operation. A no-op
+// on targets without such a mode.
+class ScopedFlushDenormals {
+public:
+    ScopedFlushDenormals();
+    ~ScopedFlushDenormals();
+
+    ScopedFlushDenormals(const ScopedFlushDenormals&) = delete;
+    ScopedFlushDenormals& operator=(const ScopedFlushDenormals&) = delete;
+
+private:
+    uint64_t saved_ = 0;
+};
+
+// True when no sample is NaN or infinite. One pass of bit tests, four
+// samples at a time where SSE2 or NEON is available.
+bool allFinite(const float* buffer, size_t count);
+
+} // namespace dsp
@@ -0,0 +1,119 @@
+#include "halfband.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+constexpr double KAISER_BETA = 8.0;
+
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// Taps at offsets +-(2k + 1) from the centre. Scaled so they add up to 0.5
+// per side pair, which with the 0.5 centre tap gives exactly unity at DC.
+std::vector<float> designTaps(int halfLength) {
+    int centre = 2 * halfLength - 1;
+    double i0Beta = besselI0(KAISER_BETA);
+    std::vector<double> taps((size_t)halfLength);
+    double sum = 0.0;
+    for (int k = 0; k < halfLength; k++) {
+        int n = 2 * k + 1;
+        double w = (double)n / (centre + 1);
+        double window = besselI0(KAISER_BETA * std::sqrt(1.0 - w * w)) / i0Beta;
+        double sinc = ((k & 1) ? -1.0 : 1.0) / (PI * n);
+        taps[k] = sinc * window;
+        sum += 2.0 * taps[k];
+    }
+    std::vector<float> out((size_t)halfLength);
+    for (int k = 0; k < halfLength; k++)
+        out[k] = (float)(taps[k] * 0.5 / sum);
+    return out;
+}
+} // namespace
+
+void HalfbandDecimator::prepare(int halfLength, int maxInputFrames, int numChannels) {
+    halfLength_ = halfLength;
+    numChannels_ = numChannels;
+    taps_ = designTaps(halfLength);
+    historyStride_ = (size_t)(4 * halfLength - 2 + maxInputFrames);
+    history_.assign(historyStride_ * numChannels, 0.0f);
+    reset();
+}
+
+void HalfbandDecimator::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    skipNext_ = false;
+}
+
+int HalfbandDecimator::process(const float* const* in, int numFrames, float* const* out) {
+    const int keep = 4 * halfLength_ - 2;
+    const int centre = 2 * halfLength_ - 1;
+    const int first = skipNext_ ? 1 : 0;
+
+    for (int ch = 0; ch < numChannels_; ch++) {
+        float* x = history_.data() + ch * historyStride_;
+        std::memcpy(x + keep, in[ch], (size_t)numFrames * sizeof(float));
+
+        float* dst = out[ch];
+        for (int j = first; j < numFrames; j += 2) {
+            const float* c = x + keep + j - centre;
+            float sum = 0.5f * c[0];
+            for (int k = 0; k < halfLength_; k++) {
+                int offset = 2 * k + 1;
+                sum += taps_[k] * (c[offset] + c[-offset]);
+            }
+            *dst++ = sum;
+        }
+
+        std::memmove(x, x + numFrames, (size_t)keep * sizeof(float));
+    }
+
+    // The next block carries on the every-second-frame pattern
+    skipNext_ = ((numFrames - first) & 1) != 0;
+    return numFrames > first ? (numFrames - first + 1) / 2 : 0;
+}
+
+void HalfbandInterpolator::prepare(int halfLength, int maxInputFrames, int numChannels) {
+    halfLength_ = halfLength;
+    numChannels_ = numChannels;
+    taps_ = designTaps(halfLength);
+    historyStride_ = (size_t)(2 * halfLength - 1 + maxInputFrames);
+    history_.assign(historyStride_ * numChannels, 0.0f);
+    reset();
+}
+
+void HalfbandInterpolator::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+}
+
+void HalfbandInterpolator::process(const float* const* in, int numFrames, float* const* out) {
+    const int J = halfLength_;
+    const int keep = 2 * J - 1;
+
+    // Zero-stuffed input: even outputs see only the side taps (doubled to
+    // make up for the inserted zeros), odd outputs only the centre tap.
+    for (int ch = 0; ch < numChannels_; ch++) {
+        float* x = history_.data() + ch * historyStride_;
+        std::memcpy(x + keep, in[ch], (size_t)numFrames * sizeof(float));
+
+        float* dst = out[ch];
+        for (int j = 0; j < numFrames; j++) {
+            const float* newest = x + keep + j;
+            float sum = 0.0f;
+            for (int k = 0; k < J; k++)
+                sum += taps_[k] * (newest[-(J - 1 - k)] + newest[-(J + k)]);
+            dst[2 * j] = 2.0f * sum;
+            dst[2 * j + 1] = newest[-(J - 1)];
+        }
+
+        std::memmove(x, x + numFrames, (size_t)keep * sizeof(float));
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Linear-phase halfband FIR stages for changing the rate by two. Apart from
+// the centre tap (0.5) every other tap is zero, so an output frame costs
+// halfLength multiplies per channel. Buffers are planar, one array per
+// channel.
+
+class HalfbandDecimator {
+public:
+    // halfLength non-zero taps on each side of the centre, 4 * halfLength - 1
+    // in total. Allocates; not real-time safe.
+    void prepare(int halfLength, int maxInputFrames, int numChannels);
+    void reset();
+
+    // Keeps every second frame, starting with the first one after reset().
+    // Returns the number of frames written to out.
+    int process(const float* const* in, int numFrames, float* const* out);
+
+    // Group delay in input frames
+    int getLatency() const { return 2 * halfLength_ - 1; }
+
+private:
+    std::vector<float> taps_;
+    // One run of history per channel, historyStride_ floats apart
+    std::vector<float> history_;
+    size_t historyStride_ = 0;
+    int halfLength_ = 0;
+    int numChannels_ = 2;
+    bool skipNext_ = false;
+};
+
+class HalfbandInterpolator {
+public:
+    void prepare(int halfLength, int maxInputFrames, int numChannels);
+    void reset();
+
+    // Writes 2 * numFrames frames to out
+    void process(const float* const* in, int numFrames, float* const* out);
+
+    // Group delay in output frames
+    int getLatency() const { return 2 * halfLength_ - 1; }
+
+private:
+    std::vector<float> taps_;
+    // One run of history per channel, historyStride_ floats apart
+    std::vector<float> history_;
+    size_t historyStride_ = 0;
+    int halfLength_ = 0;
+    int numChannels_ = 2;
+};
@@ -0,0 +1,155 @@
+// AVX2 + FMA kernels: eight lanes, four biquad sections per register. Only
+// this unit is built for AVX2, through target pragmas rather than a compiler
+// flag, so build/compile.sh can keep compiling every file in one command;
+// nothing here runs unless cpu_dispatch found the CPU supports it. That
+// build is MinGW-w64, whose stack is only 16-byte aligned, so it assembles
+// with -muse-unaligned-vector-move for any spilled register.
+
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+namespace dsp {
+namespace {
+
+struct V {
+    static constexpr int WIDTH = 8;
+    static constexpr bool FMA = true;
+    using Mask = __m256;
+    __m256 r;
+
+    static V load(const float* p) { return { _mm256_load_ps(p) }; }
+    static V loadu(const float* p) { return { _mm256_loadu_ps(p) }; }
+    void store(float* p) const { _mm256_store_ps(p, r); }
+    void storeu(float* p) const { _mm256_storeu_ps(p, r); }
+    static V zero() { return { _mm256_setzero_ps() }; }
+    static V set1(float x) { return { _mm256_set1_ps(x) }; }
+
+    static V add(V a, V b) { return { _mm256_add_ps(a.r, b.r) }; }
+    static V sub(V a, V b) { return { _mm256_sub_ps(a.r, b.r) }; }
+    static V mul(V a, V b) { return { _mm256_mul_ps(a.r, b.r) }; }
+    static V div(V a, V b) { return { _mm256_div_ps(a.r, b.r) }; }
+    static V min(V a, V b) { return { _mm256_min_ps(a.r, b.r) }; }
+    static V max(V a, V b) { return { _mm256_max_ps(a.r, b.r) }; }
+    static V madd(V a, V b, V c) { return { _mm256_fmadd_ps(a.r, b.r, c.r) }; }
+    static V nmadd(V a, V b, V c) { return { _mm256_fnmadd_ps(a.r, b.r, c.r) }; }
+
+    static V abs(V a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.r) }; }
+    static V copySign(V mag, V sign) {
+        __m256 s = _mm256_and_ps(sign.r, _mm256_set1_ps(-0.0f));
+        return { _mm256_or_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), mag.r), s) };
+    }
+    static V round(V a) { return { _mm256_round_ps(a.r, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+    static V pow2(V n) {
+        __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n.r), _mm256_set1_epi32(127));
+        return { _mm256_castsi256_ps(_mm256_slli_epi32(e, 23)) };
+    }
+    static V exponent(V a) {
+        __m256i e = _mm256_srli_epi32(_mm256_castps_si256(a.r), 23);
+        return { _mm256_cvtepi32_ps(_mm256_sub_epi32(e, _mm256_set1_epi32(127))) };
+    }
+    static V mantissa(V a) {
+        __m256 bits = _mm256_and_ps(a.r, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF)));
+        return { _mm256_or_ps(bits, _mm256_set1_ps(1.0f)) };
+    }
+    static float hsum(V a) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(a.r), _mm256_extractf128_ps(a.r, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(s);
+    }
+
+    static Mask le(V a, V b) { return _mm256_cmp_ps(a.r, b.r, _CMP_LE_OQ); }
+    static Mask gt(V a, V b) { return _mm256_cmp_ps(a.r, b.r, _CMP_GT_OQ); }
+    static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static bool any(Mask m) { return _mm256_movemask_ps(m) != 0; }
+    static V select(Mask m, V a, V b) { return { _mm256_blendv_ps(b.r, a.r, m) }; }
+
+    static V shiftIn(V y, const float* left, const float* right) {
+        __m256 up = _mm256_permutevar8x32_ps(y.r, _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 4, 5));
+        __m256 x = _mm256_castps128_ps256(_mm_unpacklo_ps(_mm_load_ss(left), _mm_load_ss(right)));
+        return { _mm256_blend_ps(up, x, 0x03) };
+    }
+    static V shiftInMono(V y, float in) {
+        __m256 up = _mm256_permutevar8x32_ps(y.r, _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 4, 5));
+        return { _mm256_blend_ps(up, _mm256_setr_ps(in, 0, 0, 0, 0, 0, 0, 0), 0x03) };
+    }
+    static void storeLast(V y, float* left, float* right) {
+        __m128 hi = _mm256_extractf128_ps(y.r, 1);
+        _mm_store_ss(left, _mm_movehl_ps(hi, hi));
+        _mm_store_ss(right, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    static void storeLastMono(V y, float* out) {
+        __m128 hi = _mm256_extractf128_ps(y.r, 1);
+        _mm_store_ss(out, _mm_movehl_ps(hi, hi));
+    }
+
+    // The in-lane shuffles leave the 128-bit halves crossed; one permute
+    // puts them back in order
+    static void unzip(const float* p, V& even, V& odd) {
+        __m256 a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+        __m256 e = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 o = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        even.r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(e), _MM_SHUFFLE(3, 1, 2, 0)));
+        odd.r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(o), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    static void zip(float* p, V even, V odd) {
+        __m256 lo = _mm256_unpacklo_ps(even.r, odd.r);
+        __m256 hi = _mm256_unpackhi_ps(even.r, odd.r);
+        _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    // 4x4 transposes within each 128-bit half, then the halves swapped
+    // between rows i and i + 4
+    static void transpose(V* rows) {
+        __m256 t[8], u[8];
+        for (int i = 0; i < 8; i += 2) {
+            t[i] = _mm256_unpacklo_ps(rows[i].r, rows[i + 1].r);
+            t[i + 1] = _mm256_unpackhi_ps(rows[i].r, rows[i + 1].r);
+        }
+        for (int i = 0; i < 8; i += 4) {
+            u[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (int i = 0; i < 4; i++) {
+            rows[i].r = _mm256_permute2f128_ps(u[i], u[i + 4], 0x20);
+            rows[i + 4].r = _mm256_permute2f128_ps(u[i], u[i + 4], 0x31);
+        }
+    }
+};
+
+#include "kernels_impl.h"
+
+constexpr Kernels TABLE = makeKernels<V>(Isa::AVX2);
+
+} // namespace
+} // namespace dsp
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace dsp {
+const Kernels* avx2Kernels() { return &TABLE; }
+} // namespace dsp
+
+#else
+
+namespace dsp {
+const Kernels* avx2Kernels() { return nullptr; }
+} // namespace dsp
+
+#endif
@@ -0,0 +1,165 @@
+// AVX-512F kernels: sixteen lanes, eight biquad sections per register and
+// the whole comb bank in one. Built through target pragmas like the AVX2
+// unit; only reached once cpu_dispatch has seen AVX-512F and OS support for
+// the wide registers.
+
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+// GCC 12's avx512fintrin.h seeds its conversions with _mm512_undefined_*()
+// and then warns about it
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace dsp {
+namespace {
+
+struct V {
+    static constexpr int WIDTH = 16;
+    static constexpr bool FMA = true;
+    using Mask = __mmask16;
+    __m512 r;
+
+    static V load(const float* p) { return { _mm512_load_ps(p) }; }
+    static V loadu(const float* p) { return { _mm512_loadu_ps(p) }; }
+    void store(float* p) const { _mm512_store_ps(p, r); }
+    void storeu(float* p) const { _mm512_storeu_ps(p, r); }
+    static V zero() { return { _mm512_setzero_ps() }; }
+    static V set1(float x) { return { _mm512_set1_ps(x) }; }
+
+    static V add(V a, V b) { return { _mm512_add_ps(a.r, b.r) }; }
+    static V sub(V a, V b) { return { _mm512_sub_ps(a.r, b.r) }; }
+    static V mul(V a, V b) { return { _mm512_mul_ps(a.r, b.r) }; }
+    static V div(V a, V b) { return { _mm512_div_ps(a.r, b.r) }; }
+    static V min(V a, V b) { return { _mm512_min_ps(a.r, b.r) }; }
+    static V max(V a, V b) { return { _mm512_max_ps(a.r, b.r) }; }
+    static V madd(V a, V b, V c) { return { _mm512_fmadd_ps(a.r, b.r, c.r) }; }
+    static V nmadd(V a, V b, V c) { return { _mm512_fnmadd_ps(a.r, b.r, c.r) }; }
+
+    // Bitwise float operations are AVX512DQ, so go through the integer ones
+    static V abs(V a) {
+        return { _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a.r),
+                                                      _mm512_set1_epi32(0x7FFFFFFF))) };
+    }
+    static V copySign(V mag, V sign) {
+        __m512i m = _mm512_and_epi32(_mm512_castps_si512(mag.r), _mm512_set1_epi32(0x7FFFFFFF));
+        __m512i s = _mm512_and_epi32(_mm512_castps_si512(sign.r), _mm512_set1_epi32((int)0x80000000u));
+        return { _mm512_castsi512_ps(_mm512_or_epi32(m, s)) };
+    }
+    static V round(V a) { return { _mm512_roundscale_ps(a.r, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+    static V pow2(V n) {
+        __m512i e = _mm512_add_epi32(_mm512_cvtps_epi32(n.r), _mm512_set1_epi32(127));
+        return { _mm512_castsi512_ps(_mm512_slli_epi32(e, 23)) };
+    }
+    static V exponent(V a) {
+        __m512i e = _mm512_srli_epi32(_mm512_castps_si512(a.r), 23);
+        return { _mm512_cvtepi32_ps(_mm512_sub_epi32(e, _mm512_set1_epi32(127))) };
+    }
+    static V mantissa(V a) {
+        __m512i bits = _mm512_and_epi32(_mm512_castps_si512(a.r), _mm512_set1_epi32(0x007FFFFF));
+        return { _mm512_castsi512_ps(_mm512_or_epi32(bits, _mm512_set1_epi32(0x3F800000))) };
+    }
+    static float hsum(V a) { return _mm512_reduce_add_ps(a.r); }
+
+    static Mask le(V a, V b) { return _mm512_cmp_ps_mask(a.r, b.r, _CMP_LE_OQ); }
+    static Mask gt(V a, V b) { return _mm512_cmp_ps_mask(a.r, b.r, _CMP_GT_OQ); }
+    static Mask both(Mask a, Mask b) { return (Mask)(a & b); }
+    static bool any(Mask m) { return m != 0; }
+    static V select(Mask m, V a, V b) { return { _mm512_mask_blend_ps(m, b.r, a.r) }; }
+
+    static __m512 shiftUp(__m512 y) {
+        const __m512i up = _mm512_setr_epi32(0, 1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13);
+        return _mm512_permutexvar_ps(up, y);
+    }
+    static V shiftIn(V y, const float* left, const float* right) {
+        __m512 x = _mm512_castps128_ps512(_mm_unpacklo_ps(_mm_load_ss(left), _mm_load_ss(right)));
+        return { _mm512_mask_blend_ps(0x0003, shiftUp(y.r), x) };
+    }
+    static V shiftInMono(V y, float in) {
+        return { _mm512_mask_blend_ps(0x0003, shiftUp(y.r), _mm512_castps128_ps512(_mm_set_ss(in))) };
+    }
+    static void storeLast(V y, float* left, float* right) {
+        __m128 hi = _mm512_extractf32x4_ps(y.r, 3);
+        _mm_store_ss(left, _mm_movehl_ps(hi, hi));
+        _mm_store_ss(right, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    static void storeLastMono(V y, float* out) {
+        __m128 hi = _mm512_extractf32x4_ps(y.r, 3);
+        _mm_store_ss(out, _mm_movehl_ps(hi, hi));
+    }
+
+    static void unzip(const float* p, V& even, V& odd) {
+        __m512 a = _mm512_loadu_ps(p), b = _mm512_loadu_ps(p + 16);
+        const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i odds = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        even.r = _mm512_permutex2var_ps(a, evens, b);
+        odd.r = _mm512_permutex2var_ps(a, odds, b);
+    }
+    static void zip(float* p, V even, V odd) {
+        const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        _mm512_storeu_ps(p, _mm512_permutex2var_ps(even.r, lo, odd.r));
+        _mm512_storeu_ps(p + 16, _mm512_permutex2var_ps(even.r, hi, odd.r));
+    }
+
+    // 4x4 transposes within each 128-bit block, then a 4x4 transpose of the
+    // blocks across every fourth row
+    static void transpose(V* rows) {
+        __m512 t[16], u[16];
+        for (int i = 0; i < 16; i += 2) {
+            t[i] = _mm512_unpacklo_ps(rows[i].r, rows[i + 1].r);
+            t[i + 1] = _mm512_unpackhi_ps(rows[i].r, rows[i + 1].r);
+        }
+        for (int i = 0; i < 16; i += 4) {
+            u[i] = _mm512_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 1] = _mm512_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            u[i + 2] = _mm512_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            u[i + 3] = _mm512_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (int m = 0; m < 4; m++) {
+            __m512 lo01 = _mm512_shuffle_f32x4(u[m], u[m + 4], _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 hi01 = _mm512_shuffle_f32x4(u[m], u[m + 4], _MM_SHUFFLE(3, 2, 3, 2));
+            __m512 lo23 = _mm512_shuffle_f32x4(u[m + 8], u[m + 12], _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 hi23 = _mm512_shuffle_f32x4(u[m + 8], u[m + 12], _MM_SHUFFLE(3, 2, 3, 2));
+            rows[m].r = _mm512_shuffle_f32x4(lo01, lo23, _MM_SHUFFLE(2, 0, 2, 0));
+            rows[m + 4].r = _mm512_shuffle_f32x4(lo01, lo23, _MM_SHUFFLE(3, 1, 3, 1));
+            rows[m + 8].r = _mm512_shuffle_f32x4(hi01, hi23, _MM_SHUFFLE(2, 0, 2, 0));
+            rows[m + 12].r = _mm512_shuffle_f32x4(hi01, hi23, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+    }
+};
+
+#include "kernels_impl.h"
+
+constexpr Kernels TABLE = makeKernels<V>(Isa::AVX512);
+
+} // namespace
+} // namespace dsp
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+namespace dsp {
+const Kernels* avx512Kernels() { return &TABLE; }
+} // namespace dsp
+
+#else
+
+namespace dsp {
+const Kernels* avx512Kernels() { return nullptr; }
+} // namespace dsp
+
+#endif
@@ -0,0 +1,456 @@
+// Bodies of the vector kernels, written once against a register wrapper V
+// that each ISA's translation unit defines just before including this file.
+// The include sits inside that unit's anonymous namespace and after its
+// target pragmas, so every copy is private to its unit and compiled for its
+// own instruction set. No headers here: anything pulled in after the pragmas
+// would be built for the wider ISA and could be linked into baseline code.
+//
+// Arrays on the stack go through loadu/storeu even when declared
+// alignas(64): 64-bit Windows GCC does not realign the stack past 16 bytes,
+// so the alignment is a hint for the cache, not a promise.
+//
+// V provides WIDTH lanes of float with load/loadu (aligned/unaligned),
+// store/storeu, zero, set1, add, sub, mul, div, min, max, abs, madd (a*b+c,
+// fused where FMA is set), nmadd (c-a*b, FMA builds only), round, pow2 (2^n
+// for integral n), exponent and mantissa (the unbiased exponent and the
+// [1, 2) significand of positive normal floats), copySign, hsum, the Mask
+// type with le, gt, both, any and select, and the lane-pair moves the biquad
+// pipeline needs: shiftIn and shiftInMono put a new frame in pair 0 and move
+// every other pair up one, storeLast and storeLastMono write out the top
+// pair. unzip splits 2 * WIDTH interleaved floats into their even and odd
+// elements; zip undoes it. transpose turns WIDTH registers, taken as the
+// rows of a square, into its columns.
+
+inline float absf(float x) { return x < 0.0f ? -x : x; }
+inline float maxf(float a, float b) { return a > b ? a : b; }
+
+template<class V>
+void applyGainImpl(float* samples, size_t count, float gain) {
+    const V g = V::set1(gain);
+    size_t i = 0;
+    for (; i + V::WIDTH <= count; i += V::WIDTH)
+        V::mul(V::loadu(samples + i), g).storeu(samples + i);
+    for (; i < count; i++)
+        samples[i] *= gain;
+}
+
+template<class V>
+void multiplyImpl(float* samples, const float* gains, size_t count) {
+    size_t i = 0;
+    for (; i + V::WIDTH <= count; i += V::WIDTH)
+        V::mul(V::loadu(samples + i), V::loadu(gains + i)).storeu(samples + i);
+    for (; i < count; i++)
+        samples[i] *= gains[i];
+}
+
+template<class V>
+void peakLevelsImpl(const float* in, int numFrames, int numChannels, float& peakL, float& peakR) {
+    float left = 0.0f, right = 0.0f;
+
+    if (numChannels <= 2) {
+        // Contiguous samples: for stereo the even lanes see left, the odd
+        // lanes right
+        bool stereo = (numChannels == 2);
+        size_t count = (size_t)numFrames * numChannels;
+        V m = V::zero();
+        size_t i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH)
+            m = V::max(m, V::abs(V::loadu(in + i)));
+
+        alignas(64) float lanes[V::WIDTH];
+        m.storeu(lanes);
+        for (int k = 0; k < V::WIDTH; k++) {
+            if (stereo && (k & 1)) right = maxf(right, lanes[k]);
+            else                   left = maxf(left, lanes[k]);
+        }
+        for (; i < count; i++) {
+            if (stereo && (i & 1)) right = maxf(right, absf(in[i]));
+            else                   left = maxf(left, absf(in[i]));
+        }
+    } else {
+        for (int frame = 0; frame < numFrames; frame++) {
+            const float* p = in + (size_t)frame * numChannels;
+            left = maxf(left, absf(p[0]));
+            right = maxf(right, absf(p[1]));
+        }
+    }
+
+    peakL = left;
+    peakR = right;
+}
+
+// tanh of x in [0, 9] as (1 - e) / (1 + e), e = exp(-2x) = 2^(-2x log2(e)).
+// The exponential splits into 2^n and a degree-6 polynomial for 2^f over
+// f in [-0.5, 0.5], good to about 1.5e-7 relative.
+template<class V>
+V tanhPositive(V x) {
+    V y = V::mul(x, V::set1(-2.8853900817779268f));
+    V n = V::round(y);
+    V f = V::sub(y, n);
+    V p = V::set1(1.5403530393381609e-4f);
+    p = V::madd(p, f, V::set1(1.3333558146428443e-3f));
+    p = V::madd(p, f, V::set1(9.6181291076284772e-3f));
+    p = V::madd(p, f, V::set1(5.5504108664821580e-2f));
+    p = V::madd(p, f, V::set1(2.4022650695910071e-1f));
+    p = V::madd(p, f, V::set1(6.9314718055994531e-1f));
+    p = V::madd(p, f, V::set1(1.0f));
+    V e = V::mul(p, V::pow2(n));
+    V one = V::set1(1.0f);
+    return V::div(V::sub(one, e), V::add(one, e));
+}
+
+template<class V>
+V softClipVector(V x, V threshold, V headroom, V invHeadroom) {
+    V ax = V::abs(x);
+    typename V::Mask over = V::gt(ax, threshold);
+    if (!V::any(over)) return x;
+    // tanh(9) rounds to 1, so larger arguments change nothing
+    V t = V::min(V::mul(V::sub(ax, threshold), invHeadroom), V::set1(9.0f));
+    V y = V::madd(headroom, tanhPositive(t), threshold);
+    return V::select(over, V::copySign(y, x), x);
+}
+
+template<class V>
+void softClipImpl(float* samples, size_t count, float threshold) {
+    const V th = V::set1(threshold);
+    const V head = V::set1(1.0f - threshold);
+    const V invHead = V::set1(1.0f / (1.0f - threshold));
+
+    size_t i = 0;
+    for (; i + V::WIDTH <= count; i += V::WIDTH)
+        softClipVector(V::loadu(samples + i), th, head, invHead).storeu(samples + i);
+
+    // The tail goes through the same curve as the rest
+    if (i < count) {
+        alignas(64) float tail[V::WIDTH] = {};
+        size_t rest = count - i;
+        for (size_t k = 0; k < rest; k++) tail[k] = samples[i + k];
+        softClipVector(V::loadu(tail), th, head, invHead).storeu(tail);
+        for (size_t k = 0; k < rest; k++) samples[i + k] = tail[k];
+    }
+}
+
+// log2 of positive normal floats: the exponent, plus the mantissa m through
+// the atanh series of t = (m - 1) / (m + 1). Worst error is around 1e-5 dB
+// once scaled to decibels.
+template<class V>
+V log2Approx(V x) {
+    const V one = V::set1(1.0f);
+    V m = V::mantissa(x);
+    V t = V::div(V::sub(m, one), V::add(m, one));
+    V t2 = V::mul(t, t);
+    V p = V::madd(t2, V::set1(1.0f / 9.0f), V::set1(1.0f / 7.0f));
+    p = V::madd(t2, p, V::set1(1.0f / 5.0f));
+    p = V::madd(t2, p, V::set1(1.0f / 3.0f));
+    p = V::madd(t2, p, one);
+    return V::add(V::exponent(x), V::mul(V::mul(t, p), V::set1(2.0f / 0.69314718f)));
+}
+
+// 2^x for x in [-126, 126]: the nearest integer through pow2, the remainder
+// (within +-0.5) through a degree-6 Taylor series of e^(r ln2)
+template<class V>
+V exp2Approx(V x) {
+    x = V::max(V::min(x, V::set1(126.0f)), V::set1(-126.0f));
+    V n = V::round(x);
+    V r = V::mul(V::sub(x, n), V::set1(0.69314718f));
+    V p = V::madd(r, V::set1(1.0f / 720.0f), V::set1(1.0f / 120.0f));
+    p = V::madd(r, p, V::set1(1.0f / 24.0f));
+    p = V::madd(r, p, V::set1(1.0f / 6.0f));
+    p = V::madd(r, p, V::set1(0.5f));
+    p = V::madd(r, p, V::set1(1.0f));
+    p = V::madd(r, p, V::set1(1.0f));
+    return V::mul(p, V::pow2(n));
+}
+
+// Up to count floats of a row; the rest of the register is zero
+template<class V>
+inline V loadPartial(const float* p, int count) {
+    if (count == V::WIDTH) return V::loadu(p);
+    alignas(64) float row[V::WIDTH] = {};
+    for (int i = 0; i < count; i++) row[i] = p[i];
+    return V::loadu(row);
+}
+
+template<class V>
+inline void storePartial(V v, float* p, int count) {
+    if (count == V::WIDTH) {
+        v.storeu(p);
+        return;
+    }
+    alignas(64) float row[V::WIDTH];
+    v.storeu(row);
+    for (int i = 0; i < count; i++) p[i] = row[i];
+}
+
+// Lanes are compressors, WIDTH at a time. Each square of WIDTH lanes by
+// WIDTH frames is transposed on the way in, so every register holds one
+// frame across the lanes for the envelope to step through, and back again on
+// the way out. Lanes past numLanes run on silence and are not stored.
+template<class V>
+void compressorBankImpl(const float* peaks, float* gains, size_t stride, int numLanes,
+                        int numFrames, const BankGainComputer& gc, const float* outGain,
+                        float* envDb, float* reductionDb) {
+    const V attack = V::set1(gc.attackCoeff);
+    const V release = V::set1(gc.releaseCoeff);
+    const V threshold = V::set1(gc.thresholdDb);
+    const V slope = V::set1(gc.slope);
+    const V kneeBottom = V::set1(gc.kneeBottomDb);
+    const V kneeTop = V::set1(gc.kneeTopDb);
+    const V kneeScale = V::set1(gc.kneeScale);
+    const V expansionSlope = V::set1(gc.expansionSlope);
+    const V gate = V::set1(gc.gateThresholdDb);
+    const V floorDb = V::set1(-96.0f);
+    const V maxReduction = V::set1(96.0f);
+    const V silence = V::set1(1e-10f);
+    const V dbPerLog2 = V::set1(6.0205999f);        // 20 * log10(2)
+    const V log2PerDb = V::set1(-0.16609640f);      // -log2(10) / 20
+    const V one = V::set1(1.0f);
+    const V zero = V::zero();
+
+    for (int group = 0; group < numLanes; group += V::WIDTH) {
+        const int lanes = numLanes - group < V::WIDTH ? numLanes - group : V::WIDTH;
+        V env = V::loadu(envDb + group);
+        V deepest = zero;
+        const V out = V::loadu(outGain + group);
+        V square[V::WIDTH];
+
+        for (int frame = 0; frame < numFrames; frame += V::WIDTH) {
+            const int count = numFrames - frame < V::WIDTH ? numFrames - frame : V::WIDTH;
+            for (int i = 0; i < V::WIDTH; i++)
+                square[i] = (i < lanes) ? loadPartial<V>(peaks + (group + i) * stride + frame, count)
+                                        : zero;
+            V::transpose(square);
+
+            for (int t = 0; t < count; t++) {
+                V peak = square[t];
+                V inputDb = V::select(V::gt(silence, peak), floorDb,
+                                      V::mul(log2Approx(V::max(peak, silence)), dbPerLog2));
+
+                V coeff = V::select(V::gt(inputDb, env), attack, release);
+                env = V::madd(coeff, env, V::mul(V::sub(one, coeff), inputDb));
+
+                V above = V::mul(V::sub(env, threshold), slope);
+                V x = V::sub(env, kneeBottom);
+                V inKnee = V::mul(V::mul(x, x), kneeScale);
+                V compression = V::select(V::gt(kneeTop, env),
+                                          V::select(V::gt(env, kneeBottom), inKnee, zero), above);
+                V expansion = V::mul(V::max(V::sub(kneeBottom, env), zero), expansionSlope);
+                V reduction = V::select(V::both(V::le(compression, zero), V::gt(kneeBottom, env)),
+                                        expansion, compression);
+                typename V::Mask gated = V::le(env, gate);
+                deepest = V::max(deepest, V::select(gated, zero, compression));
+                reduction = V::select(gated, maxReduction, V::min(reduction, maxReduction));
+
+                square[t] = V::mul(exp2Approx(V::mul(reduction, log2PerDb)), out);
+            }
+
+            V::transpose(square);
+            for (int i = 0; i < lanes; i++)
+                storePartial(square[i], gains + (group + i) * stride + frame, count);
+        }
+        env.storeu(envDb + group);
+        deepest.storeu(reductionDb + group);
+    }
+}
+
+// One biquad step on every lane. Without FMA the operations keep the order
+// of the scalar Biquad, so the SSE2 build matches it bit for bit.
+template<class V>
+inline V biquadLanes(V x, const V* k, V& z1, V& z2) {
+    V y;
+    if constexpr (V::FMA) {
+        y = V::madd(k[0], x, z1);
+        z1 = V::nmadd(k[3], y, V::madd(k[1], x, z2));
+        z2 = V::nmadd(k[4], y, V::mul(k[2], x));
+    } else {
+        y = V::add(V::mul(k[0], x), z1);
+        z1 = V::add(V::sub(V::mul(k[1], x), V::mul(k[3], y)), z2);
+        z2 = V::sub(V::mul(k[2], x), V::mul(k[4], y));
+    }
+    return y;
+}
+
+// Pipeline step t. Masked steps fill or drain the pipeline: pair k only
+// advances its state while t - k is a real frame.
+template<class V, bool Stereo, bool Masked>
+inline void cascadeStep(const float* inL, const float* inR, float* outL, float* outR,
+                        V& y, V& z1, V& z2, const V* k, V stageIndex, int t, int numFrames) {
+    V x = Stereo ? V::shiftIn(y, inL, inR) : V::shiftInMono(y, *inL);
+    V n1 = z1, n2 = z2;
+    y = biquadLanes(x, k, n1, n2);
+    if (Masked) {
+        typename V::Mask active = V::both(V::le(stageIndex, V::set1((float)t)),
+                                          V::gt(stageIndex, V::set1((float)(t - numFrames))));
+        z1 = V::select(active, n1, z1);
+        z2 = V::select(active, n2, z2);
+    } else {
+        z1 = n1;
+        z2 = n2;
+    }
+    if (outL) {
+        if (Stereo) V::storeLast(y, outL, outR);
+        else        V::storeLastMono(y, outL);
+    }
+}
+
+// Up to WIDTH / 2 sections, one per lane pair, as a skewed pipeline: while
+// pair 0 takes frame t, pair k works on frame t - k, so every section
+// advances in the same instruction and the result leaves the top pair
+// WIDTH / 2 - 1 frames after its input went in. Short groups are padded at
+// the bottom with pass-through sections. Input frames are read ahead of the
+// output ones, so the channels are filtered in place.
+template<class V, bool Stereo>
+void cascadeGroup(const BiquadCoeffs* c, StereoBiquadState* s, int n,
+                  float* left, float* right, int numFrames) {
+    constexpr int PAIRS = V::WIDTH / 2;
+    alignas(64) float coeffs[5][V::WIDTH];
+    alignas(64) float z1Lanes[V::WIDTH], z2Lanes[V::WIDTH], stage[V::WIDTH];
+    const int pad = PAIRS - n;
+
+    for (int pair = 0; pair < PAIRS; pair++) {
+        int i = pair - pad;
+        for (int ch = 0; ch < 2; ch++) {
+            int lane = 2 * pair + ch;
+            stage[lane] = (float)pair;
+            if (i >= 0) {
+                coeffs[0][lane] = c[i].b0;
+                coeffs[1][lane] = c[i].b1;
+                coeffs[2][lane] = c[i].b2;
+                coeffs[3][lane] = c[i].a1;
+                coeffs[4][lane] = c[i].a2;
+                z1Lanes[lane] = s[i].z1[ch];
+                z2Lanes[lane] = s[i].z2[ch];
+            } else {
+                coeffs[0][lane] = 1.0f;
+                coeffs[1][lane] = coeffs[2][lane] = coeffs[3][lane] = coeffs[4][lane] = 0.0f;
+                z1Lanes[lane] = z2Lanes[lane] = 0.0f;
+            }
+        }
+    }
+
+    const V k[5] = { V::loadu(coeffs[0]), V::loadu(coeffs[1]), V::loadu(coeffs[2]),
+                     V::loadu(coeffs[3]), V::loadu(coeffs[4]) };
+    const V stageIndex = V::loadu(stage);
+    V z1 = V::loadu(z1Lanes);
+    V z2 = V::loadu(z2Lanes);
+    V y = V::zero();
+
+    const float silence = 0.0f;
+    const int lag = PAIRS - 1;
+    const int steps = numFrames + lag;
+    // Mono reads and writes only the left lane
+    if (!Stereo) right = left;
+
+    int t = 0;
+    for (; t < lag; t++) {
+        bool real = t < numFrames;
+        cascadeStep<V, Stereo, true>(real ? left + t : &silence, real ? right + t : &silence,
+                                     nullptr, nullptr, y, z1, z2, k, stageIndex, t, numFrames);
+    }
+    for (; t < numFrames; t++)
+        cascadeStep<V, Stereo, false>(left + t, right + t, left + t - lag, right + t - lag,
+                                      y, z1, z2, k, stageIndex, t, numFrames);
+    for (; t < steps; t++)
+        cascadeStep<V, Stereo, true>(&silence, &silence, left + t - lag, right + t - lag,
+                                     y, z1, z2, k, stageIndex, t, numFrames);
+
+    z1.storeu(z1Lanes);
+    z2.storeu(z2Lanes);
+    for (int i = 0; i < n; i++) {
+        for (int ch = 0; ch < 2; ch++) {
+            s[i].z1[ch] = z1Lanes[2 * (i + pad) + ch];
+            s[i].z2[ch] = z2Lanes[2 * (i + pad) + ch];
+        }
+    }
+}
+
+template<class V>
+void biquadCascadeImpl(const BiquadCoeffs* coeffs, StereoBiquadState* state, int numSections,
+                       float* const* channels, int numFrames, int numChannels) {
+    if (numFrames <= 0) return;
+    constexpr int PAIRS = V::WIDTH / 2;
+    for (int first = 0; first < numSections; first += PAIRS) {
+        int n = numSections - first < PAIRS ? numSections - first : PAIRS;
+        if (numChannels >= 2)
+            cascadeGroup<V, true>(coeffs + first, state + first, n, channels[0], channels[1], numFrames);
+        else
+            cascadeGroup<V, false>(coeffs + first, state + first, n, channels[0], nullptr, numFrames);
+    }
+}
+
+// Lanes are combs: each row of taps is one frame across the whole bank.
+template<class V>
+void combBankImpl(float* taps, const float* input, float* filterState, const float* feedback,
+                  const float* gain, float damping, float* output, int numFrames) {
+    constexpr int NV = COMB_BANK_LANES / V::WIDTH;
+    V state[NV], fb[NV], g[NV];
+    for (int j = 0; j < NV; j++) {
+        state[j] = V::loadu(filterState + j * V::WIDTH);
+        fb[j] = V::loadu(feedback + j * V::WIDTH);
+        g[j] = V::loadu(gain + j * V::WIDTH);
+    }
+    const V damp = V::set1(damping);
+
+    for (int t = 0; t < numFrames; t++) {
+        float* row = taps + (size_t)t * COMB_BANK_LANES;
+        const V in = V::set1(input[t]);
+        V sum = V::zero();
+        for (int j = 0; j < NV; j++) {
+            V out = V::loadu(row + j * V::WIDTH);
+            state[j] = V::add(out, V::mul(damp, V::sub(state[j], out)));
+            V::madd(state[j], fb[j], in).storeu(row + j * V::WIDTH);
+            sum = V::madd(out, g[j], sum);
+        }
+        output[t] = V::hsum(sum);
+    }
+
+    for (int j = 0; j < NV; j++)
+        state[j].storeu(filterState + j * V::WIDTH);
+}
+
+// Stereo goes through unzip/zip a register pair at a time; any other
+// channel count is a plain strided copy.
+template<class V>
+void deinterleaveImpl(const float* in, float* const* channels, int numFrames, int numChannels) {
+    int frame = 0;
+    if (numChannels == 2) {
+        float* left = channels[0];
+        float* right = channels[1];
+        for (; frame + V::WIDTH <= numFrames; frame += V::WIDTH) {
+            V even, odd;
+            V::unzip(in + (size_t)frame * 2, even, odd);
+            even.storeu(left + frame);
+            odd.storeu(right + frame);
+        }
+    }
+    for (; frame < numFrames; frame++) {
+        const float* p = in + (size_t)frame * numChannels;
+        for (int ch = 0; ch < numChannels; ch++)
+            channels[ch][frame] = p[ch];
+    }
+}
+
+template<class V>
+void interleaveImpl(const float* const* channels, float* out, int numFrames, int numChannels) {
+    int frame = 0;
+    if (numChannels == 2) {
+        const float* left = channels[0];
+        const float* right = channels[1];
+        for (; frame + V::WIDTH <= numFrames; frame += V::WIDTH)
+            V::zip(out + (size_t)frame * 2, V::loadu(left + frame), V::loadu(right + frame));
+    }
+    for (; frame < numFrames; frame++) {
+        float* p = out + (size_t)frame * numChannels;
+        for (int ch = 0; ch < numChannels; ch++)
+            p[ch] = channels[ch][frame];
+    }
+}
+
+// constexpr so the table is constant-initialised: no code of the wider ISA
+// runs before the CPU has been checked.
+template<class V>
+constexpr Kernels makeKernels(Isa isa) {
+    return Kernels{ isa, biquadCascadeImpl<V>, combBankImpl<V>, compressorBankImpl<V>,
+                    applyGainImpl<V>, multiplyImpl<V>, peakLevelsImpl<V>, softClipImpl<V>,
+                    deinterleaveImpl<V>, interleaveImpl<V> };
+}
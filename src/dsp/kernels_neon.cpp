@@ -0,0 +1,134 @@
+// NEON kernels: four lanes, two biquad sections per register. NEON is part
+// of every AArch64 target, so no target flags; 32-bit ARM builds with NEON
+// enabled get the same code without fused multiply-add.
+
+#include "cpu_dispatch.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+
+namespace dsp {
+namespace {
+
+struct V {
+    static constexpr int WIDTH = 4;
+#if defined(__aarch64__)
+    static constexpr bool FMA = true;
+#else
+    static constexpr bool FMA = false;
+#endif
+    using Mask = uint32x4_t;
+    float32x4_t r;
+
+    static V load(const float* p) { return { vld1q_f32(p) }; }
+    static V loadu(const float* p) { return { vld1q_f32(p) }; }
+    void store(float* p) const { vst1q_f32(p, r); }
+    void storeu(float* p) const { vst1q_f32(p, r); }
+    static V zero() { return { vdupq_n_f32(0.0f) }; }
+    static V set1(float x) { return { vdupq_n_f32(x) }; }
+
+    static V add(V a, V b) { return { vaddq_f32(a.r, b.r) }; }
+    static V sub(V a, V b) { return { vsubq_f32(a.r, b.r) }; }
+    static V mul(V a, V b) { return { vmulq_f32(a.r, b.r) }; }
+    static V min(V a, V b) { return { vminq_f32(a.r, b.r) }; }
+    static V max(V a, V b) { return { vmaxq_f32(a.r, b.r) }; }
+    static V abs(V a) { return { vabsq_f32(a.r) }; }
+    static V copySign(V mag, V sign) {
+        return { vbslq_f32(vdupq_n_u32(0x80000000u), sign.r, mag.r) };
+    }
+    static V pow2(V n) {
+        int32x4_t e = vaddq_s32(vcvtq_s32_f32(n.r), vdupq_n_s32(127));
+        return { vreinterpretq_f32_s32(vshlq_n_s32(e, 23)) };
+    }
+    static V exponent(V a) {
+        int32x4_t e = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(a.r), 23));
+        return { vcvtq_f32_s32(vsubq_s32(e, vdupq_n_s32(127))) };
+    }
+    static V mantissa(V a) {
+        uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(a.r), vdupq_n_u32(0x007FFFFF));
+        return { vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3F800000))) };
+    }
+
+#if defined(__aarch64__)
+    static V div(V a, V b) { return { vdivq_f32(a.r, b.r) }; }
+    static V madd(V a, V b, V c) { return { vfmaq_f32(c.r, a.r, b.r) }; }
+    static V nmadd(V a, V b, V c) { return { vfmsq_f32(c.r, a.r, b.r) }; }
+    static V round(V a) { return { vrndnq_f32(a.r) }; }
+    static float hsum(V a) { return vaddvq_f32(a.r); }
+    static bool any(Mask m) { return vmaxvq_u32(m) != 0; }
+#else
+    static V div(V a, V b) {
+        float32x4_t inv = vrecpeq_f32(b.r);
+        inv = vmulq_f32(inv, vrecpsq_f32(b.r, inv));
+        inv = vmulq_f32(inv, vrecpsq_f32(b.r, inv));
+        return { vmulq_f32(a.r, inv) };
+    }
+    static V madd(V a, V b, V c) { return { vaddq_f32(vmulq_f32(a.r, b.r), c.r) }; }
+    // Half away from zero; only used where ties do not matter
+    static V round(V a) {
+        float32x4_t half = vbslq_f32(vdupq_n_u32(0x80000000u), a.r, vdupq_n_f32(0.5f));
+        return { vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a.r, half))) };
+    }
+    static float hsum(V a) {
+        float32x2_t s = vadd_f32(vget_low_f32(a.r), vget_high_f32(a.r));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+    }
+    static bool any(Mask m) {
+        uint32x2_t s = vpmax_u32(vget_low_u32(m), vget_high_u32(m));
+        return vget_lane_u32(vpmax_u32(s, s), 0) != 0;
+    }
+#endif
+
+    static Mask le(V a, V b) { return vcleq_f32(a.r, b.r); }
+    static Mask gt(V a, V b) { return vcgtq_f32(a.r, b.r); }
+    static Mask both(Mask a, Mask b) { return vandq_u32(a, b); }
+    static V select(Mask m, V a, V b) { return { vbslq_f32(m, a.r, b.r) }; }
+
+    static V shiftIn(V y, const float* left, const float* right) {
+        return { vcombine_f32(vld1_lane_f32(right, vld1_dup_f32(left), 1), vget_low_f32(y.r)) };
+    }
+    static V shiftInMono(V y, float in) {
+        return { vcombine_f32(vset_lane_f32(in, vdup_n_f32(0.0f), 0), vget_low_f32(y.r)) };
+    }
+    static void storeLast(V y, float* left, float* right) {
+        vst1_lane_f32(left, vget_high_f32(y.r), 0);
+        vst1_lane_f32(right, vget_high_f32(y.r), 1);
+    }
+    static void storeLastMono(V y, float* out) { vst1_lane_f32(out, vget_high_f32(y.r), 0); }
+
+    static void unzip(const float* p, V& even, V& odd) {
+        float32x4x2_t v = vld2q_f32(p);
+        even.r = v.val[0];
+        odd.r = v.val[1];
+    }
+    static void zip(float* p, V even, V odd) {
+        float32x4x2_t v = { { even.r, odd.r } };
+        vst2q_f32(p, v);
+    }
+    static void transpose(V* rows) {
+        float32x4x2_t a = vtrnq_f32(rows[0].r, rows[1].r);
+        float32x4x2_t b = vtrnq_f32(rows[2].r, rows[3].r);
+        rows[0].r = vcombine_f32(vget_low_f32(a.val[0]), vget_low_f32(b.val[0]));
+        rows[1].r = vcombine_f32(vget_low_f32(a.val[1]), vget_low_f32(b.val[1]));
+        rows[2].r = vcombine_f32(vget_high_f32(a.val[0]), vget_high_f32(b.val[0]));
+        rows[3].r = vcombine_f32(vget_high_f32(a.val[1]), vget_high_f32(b.val[1]));
+    }
+};
+
+#include "kernels_impl.h"
+
+constexpr Kernels TABLE = makeKernels<V>(Isa::NEON);
+
+} // namespace
+
+const Kernels* neonKernels() { return &TABLE; }
+
+} // namespace dsp
+
+#else
+
+namespace dsp {
+const Kernels* neonKernels() { return nullptr; }
+} // namespace dsp
+
+#endif
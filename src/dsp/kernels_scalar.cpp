@@ -0,0 +1,180 @@
+// Plain C++ kernels: the reference the vector builds are checked against,
+// and the fallback on targets with none of them.
+
+#include "cpu_dispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace dsp {
+namespace {
+
+void biquadCascade(const BiquadCoeffs* coeffs, StereoBiquadState* state, int numSections,
+                   float* const* channels, int numFrames, int numChannels) {
+    int count = std::min(numChannels, 2);
+    for (int i = 0; i < numSections; i++) {
+        const BiquadCoeffs& c = coeffs[i];
+        StereoBiquadState& s = state[i];
+        for (int ch = 0; ch < count; ch++) {
+            float* samples = channels[ch];
+            float z1 = s.z1[ch], z2 = s.z2[ch];
+            for (int frame = 0; frame < numFrames; frame++) {
+                float x = samples[frame];
+                float y = c.b0 * x + z1;
+                z1 = c.b1 * x - c.a1 * y + z2;
+                z2 = c.b2 * x - c.a2 * y;
+                samples[frame] = y;
+            }
+            s.z1[ch] = z1;
+            s.z2[ch] = z2;
+        }
+    }
+}
+
+void combBank(float* taps, const float* input, float* filterState, const float* feedback,
+              const float* gain, float damping, float* output, int numFrames) {
+    for (int t = 0; t < numFrames; t++) {
+        float* row = taps + (size_t)t * COMB_BANK_LANES;
+        float sum = 0.0f;
+        for (int i = 0; i < COMB_BANK_LANES; i++) {
+            float out = row[i];
+            filterState[i] = out + damping * (filterState[i] - out);
+            row[i] = input[t] + filterState[i] * feedback[i];
+            sum += out * gain[i];
+        }
+        output[t] = sum;
+    }
+}
+
+// The same approximations as the vector kernels, operation for operation
+float log2Approx(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float e = (float)((int32_t)(bits >> 23) - 127);
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float p = t2 * (1.0f / 9.0f) + 1.0f / 7.0f;
+    p = t2 * p + 1.0f / 5.0f;
+    p = t2 * p + 1.0f / 3.0f;
+    p = t2 * p + 1.0f;
+    return e + (t * p) * (2.0f / 0.69314718f);
+}
+
+float exp2Approx(float x) {
+    x = std::max(std::min(x, 126.0f), -126.0f);
+    float n = std::nearbyint(x);
+    float r = (x - n) * 0.69314718f;
+    float p = r * (1.0f / 720.0f) + 1.0f / 120.0f;
+    p = r * p + 1.0f / 24.0f;
+    p = r * p + 1.0f / 6.0f;
+    p = r * p + 0.5f;
+    p = r * p + 1.0f;
+    p = r * p + 1.0f;
+    uint32_t bits = (uint32_t)((int32_t)n + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+void compressorBank(const float* peaks, float* gains, size_t stride, int numLanes, int numFrames,
+                    const BankGainComputer& gc, const float* outGain, float* envDb,
+                    float* reductionDb) {
+    for (int lane = 0; lane < numLanes; lane++) {
+        const float* in = peaks + lane * stride;
+        float* out = gains + lane * stride;
+        float env = envDb[lane];
+        float deepest = 0.0f;
+
+        for (int frame = 0; frame < numFrames; frame++) {
+            float peak = in[frame];
+            float inputDb = (peak < 1e-10f) ? -96.0f : log2Approx(peak) * 6.0205999f;
+
+            float coeff = (inputDb > env) ? gc.attackCoeff : gc.releaseCoeff;
+            env = coeff * env + (1.0f - coeff) * inputDb;
+
+            float compression = 0.0f;
+            if (env >= gc.kneeTopDb) {
+                compression = (env - gc.thresholdDb) * gc.slope;
+            } else if (env > gc.kneeBottomDb) {
+                float x = env - gc.kneeBottomDb;
+                compression = x * x * gc.kneeScale;
+            }
+            float reduction = compression;
+            if (compression <= 0.0f && env < gc.kneeBottomDb)
+                reduction = std::max(gc.kneeBottomDb - env, 0.0f) * gc.expansionSlope;
+            if (env <= gc.gateThresholdDb) {
+                reduction = 96.0f;
+            } else {
+                deepest = std::max(deepest, compression);
+                reduction = std::min(reduction, 96.0f);
+            }
+
+            out[frame] = exp2Approx(reduction * -0.16609640f) * outGain[lane];
+        }
+        envDb[lane] = env;
+        reductionDb[lane] = deepest;
+    }
+}
+
+void applyGain(float* samples, size_t count, float gain) {
+    for (size_t i = 0; i < count; i++)
+        samples[i] *= gain;
+}
+
+void multiply(float* samples, const float* gains, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        samples[i] *= gains[i];
+}
+
+void peakLevels(const float* in, int numFrames, int numChannels, float& peakL, float& peakR) {
+    float left = 0.0f, right = 0.0f;
+    for (int frame = 0; frame < numFrames; frame++) {
+        const float* p = in + (size_t)frame * numChannels;
+        left = std::max(left, std::abs(p[0]));
+        if (numChannels > 1) right = std::max(right, std::abs(p[1]));
+    }
+    peakL = left;
+    peakR = right;
+}
+
+void softClip(float* samples, size_t count, float threshold) {
+    const float headroom = 1.0f - threshold;
+    for (size_t i = 0; i < count; i++) {
+        float x = samples[i];
+        float ax = std::abs(x);
+        if (ax > threshold) {
+            float sign = (x >= 0.0f) ? 1.0f : -1.0f;
+            float over = (ax - threshold) / headroom;
+            samples[i] = sign * (threshold + headroom * std::tanh(over));
+        }
+    }
+}
+
+void deinterleave(const float* in, float* const* channels, int numFrames, int numChannels) {
+    for (int frame = 0; frame < numFrames; frame++) {
+        const float* p = in + (size_t)frame * numChannels;
+        for (int ch = 0; ch < numChannels; ch++)
+            channels[ch][frame] = p[ch];
+    }
+}
+
+void interleave(const float* const* channels, float* out, int numFrames, int numChannels) {
+    for (int frame = 0; frame < numFrames; frame++) {
+        float* p = out + (size_t)frame * numChannels;
+        for (int ch = 0; ch < numChannels; ch++)
+            p[ch] = channels[ch][frame];
+    }
+}
+
+constexpr Kernels TABLE = { Isa::Scalar, biquadCascade, combBank, compressorBank, applyGain,
+                            multiply, peakLevels, softClip, deinterleave, interleave };
+
+} // namespace
+
+const Kernels* scalarKernels() { return &TABLE; }
+
+} // namespace dsp
@@ -0,0 +1,108 @@
+// SSE2 kernels: four lanes, two biquad sections per register. The x86-64
+// baseline, so this unit needs no target flags.
+
+#include "cpu_dispatch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+namespace dsp {
+namespace {
+
+struct V {
+    static constexpr int WIDTH = 4;
+    static constexpr bool FMA = false;
+    using Mask = __m128;
+    __m128 r;
+
+    static V load(const float* p) { return { _mm_load_ps(p) }; }
+    static V loadu(const float* p) { return { _mm_loadu_ps(p) }; }
+    void store(float* p) const { _mm_store_ps(p, r); }
+    void storeu(float* p) const { _mm_storeu_ps(p, r); }
+    static V zero() { return { _mm_setzero_ps() }; }
+    static V set1(float x) { return { _mm_set1_ps(x) }; }
+
+    static V add(V a, V b) { return { _mm_add_ps(a.r, b.r) }; }
+    static V sub(V a, V b) { return { _mm_sub_ps(a.r, b.r) }; }
+    static V mul(V a, V b) { return { _mm_mul_ps(a.r, b.r) }; }
+    static V div(V a, V b) { return { _mm_div_ps(a.r, b.r) }; }
+    static V min(V a, V b) { return { _mm_min_ps(a.r, b.r) }; }
+    static V max(V a, V b) { return { _mm_max_ps(a.r, b.r) }; }
+    static V madd(V a, V b, V c) { return { _mm_add_ps(_mm_mul_ps(a.r, b.r), c.r) }; }
+
+    static V abs(V a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.r) }; }
+    static V copySign(V mag, V sign) {
+        __m128 s = _mm_and_ps(sign.r, _mm_set1_ps(-0.0f));
+        return { _mm_or_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), mag.r), s) };
+    }
+    // Values here stay far below 2^31
+    static V round(V a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.r)) }; }
+    static V pow2(V n) {
+        __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n.r), _mm_set1_epi32(127));
+        return { _mm_castsi128_ps(_mm_slli_epi32(e, 23)) };
+    }
+    static V exponent(V a) {
+        __m128i e = _mm_srli_epi32(_mm_castps_si128(a.r), 23);
+        return { _mm_cvtepi32_ps(_mm_sub_epi32(e, _mm_set1_epi32(127))) };
+    }
+    static V mantissa(V a) {
+        __m128 bits = _mm_and_ps(a.r, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF)));
+        return { _mm_or_ps(bits, _mm_set1_ps(1.0f)) };
+    }
+    static float hsum(V a) {
+        __m128 s = _mm_add_ps(a.r, _mm_movehl_ps(a.r, a.r));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(s);
+    }
+
+    static Mask le(V a, V b) { return _mm_cmple_ps(a.r, b.r); }
+    static Mask gt(V a, V b) { return _mm_cmpgt_ps(a.r, b.r); }
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static bool any(Mask m) { return _mm_movemask_ps(m) != 0; }
+    static V select(Mask m, V a, V b) {
+        return { _mm_or_ps(_mm_and_ps(m, a.r), _mm_andnot_ps(m, b.r)) };
+    }
+
+    static V shiftIn(V y, const float* left, const float* right) {
+        return { _mm_movelh_ps(_mm_unpacklo_ps(_mm_load_ss(left), _mm_load_ss(right)), y.r) };
+    }
+    static V shiftInMono(V y, float in) { return { _mm_movelh_ps(_mm_set_ss(in), y.r) }; }
+    static void storeLast(V y, float* left, float* right) {
+        _mm_store_ss(left, _mm_movehl_ps(y.r, y.r));
+        _mm_store_ss(right, _mm_shuffle_ps(y.r, y.r, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    static void storeLastMono(V y, float* out) {
+        _mm_store_ss(out, _mm_movehl_ps(y.r, y.r));
+    }
+
+    static void unzip(const float* p, V& even, V& odd) {
+        __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+        even.r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        odd.r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static void zip(float* p, V even, V odd) {
+        _mm_storeu_ps(p, _mm_unpacklo_ps(even.r, odd.r));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(even.r, odd.r));
+    }
+    static void transpose(V* rows) {
+        _MM_TRANSPOSE4_PS(rows[0].r, rows[1].r, rows[2].r, rows[3].r);
+    }
+};
+
+#include "kernels_impl.h"
+
+constexpr Kernels TABLE = makeKernels<V>(Isa::SSE2);
+
+} // namespace
+
+const Kernels* sse2Kernels() { return &TABLE; }
+
+} // namespace dsp
+
+#else
+
+namespace dsp {
+const Kernels* sse2Kernels() { return nullptr; }
+} // namespace dsp
+
+#endif
@@ -0,0 +1,220 @@
+#include "linear_phase_eq.h"
+#include "dsp_common.h"
+#include "float_guard.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+constexpr double TWO_PI = 2.0 * 3.14159265358979323846;
+}
+
+LinearPhaseEQ::~LinearPhaseEQ() {
+    stopDesigner();
+}
+
+void LinearPhaseEQ::prepare(float sampleRate, int /*maxBlockFrames*/, int /*numChannels*/, ScratchArena& arena) {
+    stopDesigner();
+
+    sampleRate_ = sampleRate;
+    fft_ = RealFFT::get(FFT_SIZE);
+    designFft_ = RealFFT::get(DESIGN_FFT_SIZE);
+
+    designSpectrum_.assign(DESIGN_FFT_SIZE + 2, 0.0f);
+    designImpulse_.assign(DESIGN_FFT_SIZE, 0.0f);
+    designFir_.assign(FIR_LENGTH, 0.0f);
+    designFrame_.assign(FFT_SIZE, 0.0f);
+
+    // Periodic Blackman, symmetric about the centre tap FIR_LENGTH / 2
+    window_.resize(FIR_LENGTH);
+    for (int n = 0; n < FIR_LENGTH; n++) {
+        double x = TWO_PI * n / FIR_LENGTH;
+        window_[n] = (float)(0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x));
+    }
+
+    // Until the first design arrives every slot holds a pure delay, so the
+    // latency is the same before and after the crossfade.
+    kernelStorage_.assign((size_t)3 * KERNEL_SIZE, 0.0f);
+    std::fill(designFir_.begin(), designFir_.end(), 0.0f);
+    designFir_[FIR_LENGTH / 2] = 1.0f;
+    partitionFir(designFir_.data(), kernelStorage_.data());
+    for (int k = 1; k < 3; k++)
+        std::memcpy(&kernelStorage_[(size_t)k * KERNEL_SIZE], kernelStorage_.data(), KERNEL_SIZE * sizeof(float));
+
+    // Cycle each slab through the triple buffer so its three slots own
+    // distinct kernels; the last one published ends up as the read side.
+    for (int k = 0; k < 3; k++) {
+        kernels_.getWriteBuffer() = &kernelStorage_[(size_t)k * KERNEL_SIZE];
+        kernels_.publish();
+        activeKernel_ = kernels_.read();
+    }
+
+    for (int ch = 0; ch < 2; ch++) {
+        input_[ch] = arena.allocate<float>(FFT_SIZE);
+        output_[ch] = arena.allocate<float>(PARTITION_SIZE);
+        fdl_[ch] = arena.allocate<float>(KERNEL_SIZE);
+    }
+    accum_ = arena.allocate<float>(SPECTRUM_SIZE);
+    timeOut_ = arena.allocate<float>(FFT_SIZE);
+    fadeOut_ = arena.allocate<float>(PARTITION_SIZE);
+    fifoPos_ = 0;
+    fdlPos_ = 0;
+
+    designedVersion_.store(requestVersion_, std::memory_order_relaxed);
+}
+
+void LinearPhaseEQ::requestDesign(const StereoBiquad* filters, int numBands, float gainLinear) {
+    DesignRequest& req = requests_.getWriteBuffer();
+    req.numBands = std::min(numBands, MAX_EQ_BANDS);
+    for (int b = 0; b < req.numBands; b++)
+        req.coeffs[b] = filters[b].getCoeffs();
+    req.gainLinear = gainLinear;
+    req.sampleRate = sampleRate_;
+    req.version = ++requestVersion_;
+    requests_.publish();
+    // Chains that never turn linear phase on never pay for the thread
+    if (!designer_.joinable())
+        startDesigner();
+}
+
+void LinearPhaseEQ::startDesigner() {
+    designerRunning_.store(true, std::memory_order_release);
+    designer_ = std::thread(&LinearPhaseEQ::designerLoop, this);
+}
+
+void LinearPhaseEQ::stopDesigner() {
+    designerRunning_.store(false, std::memory_order_release);
+    if (designer_.joinable())
+        designer_.join();
+}
+
+void LinearPhaseEQ::designerLoop() {
+    dsp::ScopedFlushDenormals noDenormals;
+    while (designerRunning_.load(std::memory_order_acquire)) {
+        const DesignRequest& req = requests_.read();
+        if (req.version != designedVersion_.load(std::memory_order_relaxed) && req.sampleRate == sampleRate_) {
+            float* kernel = kernels_.getWriteBuffer();
+            designKernel(req, kernel);
+            kernels_.publish();
+            designedVersion_.store(req.version, std::memory_order_release);
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(DESIGN_POLL_MS));
+    }
+}
+
+void LinearPhaseEQ::waitForDesign() {
+    if (!designer_.joinable()) return;
+    while (designedVersion_.load(std::memory_order_acquire) != requestVersion_)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    activeKernel_ = kernels_.read();
+}
+
+void LinearPhaseEQ::designKernel(const DesignRequest& request, float* kernel) {
+    // Zero-phase spectrum from the cascade's magnitude response
+    int numBins = DESIGN_FFT_SIZE / 2 + 1;
+    for (int k = 0; k < numBins; k++) {
+        double omega = TWO_PI * k / DESIGN_FFT_SIZE;
+        double mag = request.gainLinear;
+        for (int b = 0; b < request.numBands; b++)
+            mag *= Biquad::magnitude(request.coeffs[b], omega);
+        designSpectrum_[2 * k] = (float)mag;
+        designSpectrum_[2 * k + 1] = 0.0f;
+    }
+    designFft_->inverse(designSpectrum_.data(), designImpulse_.data());
+
+    // Centre the (circular) zero-phase impulse and window it down to length
+    for (int n = 0; n < FIR_LENGTH; n++) {
+        int src = (n - FIR_LENGTH / 2 + DESIGN_FFT_SIZE) % DESIGN_FFT_SIZE;
+        designFir_[n] = designImpulse_[src] * window_[n];
+    }
+
+    partitionFir(designFir_.data(), kernel);
+}
+
+void LinearPhaseEQ::partitionFir(const float* fir, float* kernel) {
+    float* frame = designFrame_.data();
+    for (int p = 0; p < NUM_PARTITIONS; p++) {
+        std::memcpy(frame, fir + p * PARTITION_SIZE, PARTITION_SIZE * sizeof(float));
+        std::memset(frame + PARTITION_SIZE, 0, PARTITION_SIZE * sizeof(float));
+        fft_->forward(frame, kernel + p * SPECTRUM_SIZE);
+    }
+}
+
+void LinearPhaseEQ::process(float* const* channels, int numFrames, int numChannels) {
+    int count = std::min(numChannels, 2);
+
+    // Runs up to the next partition boundary go through the FIFO as whole
+    // spans of each channel
+    for (int frame = 0; frame < numFrames;) {
+        int span = std::min(numFrames - frame, PARTITION_SIZE - fifoPos_);
+        for (int ch = 0; ch < count; ch++) {
+            float* samples = channels[ch] + frame;
+            std::memcpy(input_[ch] + PARTITION_SIZE + fifoPos_, samples, span * sizeof(float));
+            std::memcpy(samples, output_[ch] + fifoPos_, span * sizeof(float));
+        }
+        frame += span;
+        fifoPos_ += span;
+        if (fifoPos_ == PARTITION_SIZE) {
+            processPartition(count);
+            fifoPos_ = 0;
+        }
+    }
+}
+
+void LinearPhaseEQ::processPartition(int numChannels) {
+    fdlPos_ = (fdlPos_ + 1) % NUM_PARTITIONS;
+    for (int ch = 0; ch < numChannels; ch++) {
+        fft_->forward(input_[ch], fdl_[ch] + fdlPos_ * SPECTRUM_SIZE);
+        std::memcpy(input_[ch], input_[ch] + PARTITION_SIZE, PARTITION_SIZE * sizeof(float));
+    }
+
+    // The outgoing kernel must be fully consumed before read() can hand its
+    // slot back to the designer.
+    const float* oldKernel = activeKernel_;
+    for (int ch = 0; ch < numChannels; ch++)
+        convolve(oldKernel, ch, output_[ch]);
+
+    const float* newKernel = kernels_.read();
+    if (newKernel == oldKernel) return;
+
+    for (int ch = 0; ch < numChannels; ch++) {
+        convolve(newKernel, ch, fadeOut_);
+        float* out = output_[ch];
+        for (int i = 0; i < PARTITION_SIZE; i++) {
+            float g = (float)(i + 1) / PARTITION_SIZE;
+            out[i] += g * (fadeOut_[i] - out[i]);
+        }
+    }
+    activeKernel_ = newKernel;
+}
+
+void LinearPhaseEQ::convolve(const float* kernel, int ch, float* out) {
+    std::memset(accum_, 0, SPECTRUM_SIZE * sizeof(float));
+
+    for (int p = 0; p < NUM_PARTITIONS; p++) {
+        int slot = (fdlPos_ - p + NUM_PARTITIONS) % NUM_PARTITIONS;
+        const float* x = fdl_[ch] + slot * SPECTRUM_SIZE;
+        const float* h = kernel + p * SPECTRUM_SIZE;
+        for (int k = 0; k < SPECTRUM_SIZE; k += 2) {
+            float xr = x[k], xi = x[k + 1];
+            float hr = h[k], hi = h[k + 1];
+            accum_[k]     += xr * hr - xi * hi;
+            accum_[k + 1] += xr * hi + xi * hr;
+        }
+    }
+
+    fft_->inverse(accum_, timeOut_);
+    std::memcpy(out, timeOut_ + PARTITION_SIZE, PARTITION_SIZE * sizeof(float));
+}
+
+void LinearPhaseEQ::reset() {
+    for (int ch = 0; ch < 2; ch++) {
+        if (input_[ch])  std::memset(input_[ch], 0, FFT_SIZE * sizeof(float));
+        if (output_[ch]) std::memset(output_[ch], 0, PARTITION_SIZE * sizeof(float));
+        if (fdl_[ch])    std::memset(fdl_[ch], 0, KERNEL_SIZE * sizeof(float));
+    }
+    fifoPos_ = 0;
+    fdlPos_ = 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "biquad.h"
+#include "fft.h"
+#include "scratch_arena.h"
+#include "common/params.h"
+#include "common/triple_buffer.h"
+
+// Linear-phase rendition of the EQ band set. A background thread samples the
+// magnitude response of the biquad cascade, turns it into a symmetric FIR and
+// hands over its partitioned spectra; the audio thread only runs uniformly
+// partitioned overlap-save convolution and crossfades into new kernels over
+// one partition.
+class LinearPhaseEQ {
+public:
+    static constexpr int FIR_LENGTH = 4096;
+    static constexpr int PARTITION_SIZE = 128;
+    static constexpr int NUM_PARTITIONS = FIR_LENGTH / PARTITION_SIZE;
+    // Half the FIR for the symmetric kernel plus one partition of buffering
+    static constexpr int LATENCY_SAMPLES = FIR_LENGTH / 2 + PARTITION_SIZE;
+
+    LinearPhaseEQ() = default;
+    ~LinearPhaseEQ();
+
+    LinearPhaseEQ(const LinearPhaseEQ&) = delete;
+    LinearPhaseEQ& operator=(const LinearPhaseEQ&) = delete;
+
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+
+    // Audio thread: queues a redesign from the current band filters. The
+    // running kernel stays in use until the new one is ready. The first
+    // request after prepare() starts the designer thread.
+    void requestDesign(const StereoBiquad* filters, int numBands, float gainLinear);
+
+    void process(float* const* channels, int numFrames, int numChannels);
+    void reset();
+
+    // Audio thread, offline use only: blocks until the latest request has been
+    // designed and switches to it without the crossfade, so a render does not
+    // depend on how quickly the designer thread was scheduled.
+    void waitForDesign();
+
+private:
+    static constexpr int FFT_SIZE = 2 * PARTITION_SIZE;
+    static constexpr int SPECTRUM_SIZE = FFT_SIZE + 2;
+    static constexpr int KERNEL_SIZE = NUM_PARTITIONS * SPECTRUM_SIZE;
+    static constexpr int DESIGN_FFT_SIZE = 2 * FIR_LENGTH;
+    static constexpr int DESIGN_POLL_MS = 5;
+
+    struct DesignRequest {
+        BiquadCoeffs coeffs[MAX_EQ_BANDS];
+        int numBands = 0;
+        float gainLinear = 1.0f;
+        float sampleRate = 0.0f;
+        uint32_t version = 0;
+    };
+
+    void startDesigner();
+    void stopDesigner();
+    void designerLoop();
+    void designKernel(const DesignRequest& request, float* kernel);
+    void partitionFir(const float* fir, float* kernel);
+
+    void processPartition(int numChannels);
+    void convolve(const float* kernel, int ch, float* out);
+
+    std::shared_ptr<const RealFFT> fft_;
+    std::shared_ptr<const RealFFT> designFft_;
+    float sampleRate_ = 48000.0f;
+
+    // Kernel spectra and design scratch are heap-owned rather than in the
+    // arena so a chain re-layout can never pull memory from under the designer.
+    std::vector<float> kernelStorage_;
+    TripleBuffer<float*> kernels_;
+    const float* activeKernel_ = nullptr;
+
+    TripleBuffer<DesignRequest> requests_;
+    uint32_t requestVersion_ = 0;
+
+    std::thread designer_;
+    std::atomic<bool> designerRunning_{false};
+    std::atomic<uint32_t> designedVersion_{0};
+    std::vector<float> designSpectrum_;
+    std::vector<float> designImpulse_;
+    std::vector<float> designFir_;
+    std::vector<float> designFrame_;
+    std::vector<float> window_;
+
+    float* input_[2] = {};
+    float* output_[2] = {};
+    float* fdl_[2] = {};
+    float* accum_ = nullptr;
+    float* timeOut_ = nullptr;
+    float* fadeOut_ = nullptr;
+    int fifoPos_ = 0;
+    int fdlPos_ = 0;
+};
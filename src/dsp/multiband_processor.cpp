@@ -1,9 +1,19 @@
 #include "multiband_processor.h"
+#include "cpu_dispatch.h"
 #include "dsp_common.h"
 #include <cmath>
 #include <algorithm>
 #include <cstring>
 
+namespace {
+// Early stages have a wide transition band to work with: the branch they
+// carry is already 24 dB/oct down above a few hundred Hz. The last one sits
+// closest to its Nyquist and gets the longer filter.
+int rateStageHalfLength(int stage, int numStages) {
+    return (stage == numStages - 1) ? 5 : 3;
+}
+} // namespace
+
 MultibandProcessor::MultibandProcessor() {
     bands_.push_back({30.0f, 250.0f, 1.0f, 0.2f, 0.0f});
     bands_.push_back({250.0f, 500.0f, 1.0f, 0.3f, 0.0f});
@@ -15,9 +25,28 @@ MultibandProcessor::MultibandProcessor() {
     bands_.push_back({12000.0f, 16000.0f, 1.0f, 0.3f, 0.0f});
     bands_.push_back({16000.0f, 20000.0f, 1.0f, 0.3f, 0.0f});
 
+    buildCrossoverTree(0, NUM_BANDS - 1, 0);
+    lowRate_.split.firstBand = 0;
+    lowRate_.split.splitBand = 0;
+    lowRate_.split.lastBand = 1;
+
+    setGlobalCompression(globalCompression_);
+    setSubBassBoost(subBassBoostDb_);
     init(48000.0f);
 }
 
+int MultibandProcessor::buildCrossoverTree(int firstBand, int lastBand, int node) {
+    if (firstBand == lastBand) return node;
+
+    CrossoverNode& xo = crossovers_[node];
+    xo.firstBand = firstBand;
+    xo.lastBand = lastBand;
+    xo.splitBand = (firstBand + lastBand) / 2;
+
+    node = buildCrossoverTree(firstBand, xo.splitBand, node + 1);
+    return buildCrossoverTree(xo.splitBand + 1, lastBand, node);
+}
+
 void MultibandProcessor::init(float sampleRate) {
     sampleRate_ = sampleRate;
 
@@ -31,10 +60,94 @@ void MultibandProcessor::init(float sampleRate) {
         proc.targetGain = 1.0f;
     }
 
+    lowRate_.numStages = 0;
+    lowRate_.sampleRate = sampleRate;
+    float lowEdge = bands_[LOW_RATE_BANDS - 1].highFreq;
+    while (lowRate_.numStages < MAX_RATE_STAGES &&
+           lowRate_.sampleRate * 0.5f >= LOW_RATE_MARGIN * lowEdge) {
+        lowRate_.numStages++;
+        lowRate_.sampleRate *= 0.5f;
+    }
+    // Each stage adds its decimator and interpolator delay, counted at the
+    // rate it runs at
+    lowRate_.latency = 0;
+    for (int s = 0; s < lowRate_.numStages; s++)
+        lowRate_.latency += (2 * (2 * rateStageHalfLength(s, lowRate_.numStages) - 1)) << s;
+
     updateFilters();
+
     initialized_ = true;
 }
 
+void MultibandProcessor::prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena) {
+    // Still points into the previous layout
+    lowRate_.highDelay = nullptr;
+
+    init(sampleRate);
+    reset();
+
+    maxBlockFrames_ = maxBlockFrames;
+    maxChannels_ = numChannels;
+    for (int b = 0; b < NUM_BANDS; b++)
+        bandBuffers_[b] = arena.allocateChannels(numChannels, (size_t)maxBlockFrames);
+    bandCompressors_.prepare(NUM_BANDS, maxBlockFrames, arena);
+    exciter_.prepare(maxBlockFrames, arena);
+
+    LowRatePath& path = lowRate_;
+    int factor = 1 << path.numStages;
+    for (int s = 0; s < path.numStages; s++) {
+        int halfLength = rateStageHalfLength(s, path.numStages);
+        path.decimators[s].prepare(halfLength, (maxBlockFrames >> s) + 1, numChannels);
+        // Fed the low-rate frames doubled once per stage below it; those
+        // round up from maxBlockFrames / factor, so halving the block size
+        // per stage can come out short
+        path.interpolators[s].prepare(halfLength, (maxBlockFrames / factor + 1) << (path.numStages - 1 - s),
+                                      numChannels);
+    }
+    for (auto& buf : path.stageBuffers)
+        buf = arena.allocateChannels(numChannels, (size_t)(maxBlockFrames / 2 + factor));
+    for (auto& buf : path.bands)
+        buf = arena.allocateChannels(numChannels, (size_t)(maxBlockFrames / factor + 1));
+    path.compressors.prepare(LOW_RATE_BANDS, maxBlockFrames / factor + 1, arena);
+    path.output = arena.allocateChannels(numChannels, (size_t)(maxBlockFrames + factor));
+    path.queued = arena.allocate<float*>((size_t)numChannels);
+    path.highDelay = arena.allocateChannels(numChannels, (size_t)std::max(1, path.latency));
+    path.outputFrames = 0;
+    path.highDelayPos = 0;
+
+    latencySamples_.store(multirate_ ? path.latency : 0, std::memory_order_relaxed);
+}
+
+void MultibandProcessor::setMultirate(bool enable) {
+    if (enable == multirate_) return;
+    multirate_ = enable;
+    resetLowRate();
+    latencySamples_.store(multirate_ ? lowRate_.latency : 0, std::memory_order_relaxed);
+}
+
+void MultibandProcessor::setGlobalCompression(float amount) {
+    globalCompression_ = amount;
+
+    CompressorSettings& cs = bandCompSettings_;
+    cs.ratio = 1.0f + (amount * 3.0f);
+    cs.thresholdDb = -12.0f;
+    cs.attackMs = 5.0f;
+    cs.releaseMs = 50.0f;
+    cs.kneeDb = 3.0f;
+    cs.enabled = amount > 0.01f;
+    cs.version++;
+}
+
+void MultibandProcessor::setOutputGain(float gainDb) {
+    outputGainDb_ = gainDb;
+    outputGainLinear_ = dsp::dbToLinear(gainDb);
+}
+
+void MultibandProcessor::setSubBassBoost(float boostDb) {
+    subBassBoostDb_ = boostDb;
+    subBassBoostLinear_ = dsp::dbToLinear(boostDb);
+}
+
 void MultibandProcessor::setSubBassRange(float lowFreq, float highFreq) {
     lowFreq = std::max(20.0f, std::min(lowFreq, 100.0f));
     highFreq = std::max(100.0f, std::min(highFreq, 500.0f));
@@ -56,144 +169,290 @@ void MultibandProcessor::setSubBassRange(float lowFreq, float highFreq) {
 }
 
 void MultibandProcessor::updateFilters() {
-    const float Q = 0.707f;
+    const float Q = 0.70710678f;
+
+    auto designSplit = [&](CrossoverNode& xo, float sampleRate) {
+        // The split between band k and k + 1 sits at band k's upper edge
+        auto crossoverCoeffs = [&](int band, Biquad::Type type) {
+            return Biquad::design(type, bands_[band].highFreq, 0.0f, Q, sampleRate);
+        };
+
+        // LR4 lowpass is a Butterworth pair in series; its highpass is
+        // derived as allpass minus lowpass in splitNode()
+        BiquadCoeffs lp = crossoverCoeffs(xo.splitBand, Biquad::Type::LowPass);
+        xo.lowpass[0].setCoeffs(lp);
+        xo.lowpass[1].setCoeffs(lp);
+        xo.allpass.setCoeffs(crossoverCoeffs(xo.splitBand, Biquad::Type::AllPass));
+
+        int n = 0;
+        for (int k = xo.splitBand + 1; k < xo.lastBand; k++)
+            xo.lowCompensation[n++].setCoeffs(crossoverCoeffs(k, Biquad::Type::AllPass));
+        n = 0;
+        for (int k = xo.firstBand; k < xo.splitBand; k++)
+            xo.highCompensation[n++].setCoeffs(crossoverCoeffs(k, Biquad::Type::AllPass));
+    };
 
-    for (size_t i = 0; i < bands_.size(); i++) {
-        auto& band = bands_[i];
-        auto& proc = processors_[i];
+    for (auto& xo : crossovers_)
+        designSplit(xo, sampleRate_);
+    designSplit(lowRate_.split, lowRate_.sampleRate);
 
-        proc.hpfL.setParams(Biquad::Type::HighPass, band.lowFreq, 0.0f, Q, sampleRate_);
-        proc.hpfR.setParams(Biquad::Type::HighPass, band.lowFreq, 0.0f, Q, sampleRate_);
-        proc.lpfL.setParams(Biquad::Type::LowPass, band.highFreq, 0.0f, Q, sampleRate_);
-        proc.lpfR.setParams(Biquad::Type::LowPass, band.highFreq, 0.0f, Q, sampleRate_);
-    }
+    subsonicFilter_.setParams(Biquad::Type::HighPass, bands_[0].lowFreq, 0.0f, Q, sampleRate_);
+    lowRate_.subsonicFilter.setParams(Biquad::Type::HighPass, bands_[0].lowFreq, 0.0f, Q, lowRate_.sampleRate);
 
     subBassRangeChanged_ = false;
 }
 
-void MultibandProcessor::updateAutoBalance() {
+void MultibandProcessor::updateAutoBalance(int numFrames) {
+    const SpectralAnalyzer::Energies& energies = analyzer_.readEnergies();
+    for (auto& band : bands_) {
+        int analyzerBand = analyzer_.findBand(band.lowFreq, band.highFreq);
+        band.energy = analyzerBand >= 0 ? energies.band[analyzerBand] : 0.0f;
+    }
+
     if (!autoBalance_) return;
 
-    float avgEnergy = analyzer_.getAverageEnergy();
+    float avgEnergy = energies.average;
     if (avgEnergy < 0.0001f) return;
 
+    float alpha = 1.0f - std::pow(1.0f - autoBalanceSpeed_ * 0.01f, numFrames / AUTO_BALANCE_FRAMES);
     for (size_t i = 0; i < bands_.size(); i++) {
         auto& band = bands_[i];
         auto& proc = processors_[i];
 
-        float energy = analyzer_.getBandEnergy(band.lowFreq, band.highFreq);
-        band.energy = energy;
-
+        float energy = band.energy;
         float energyRatio = energy / (avgEnergy + 0.0001f);
         float targetGain = 1.0f / std::sqrt(energyRatio + 0.5f);
         targetGain = std::max(0.5f, std::min(targetGain, 2.0f));
 
         float manualGainLinear = dsp::dbToLinear(band.manualGain);
         proc.targetGain = targetGain * manualGainLinear;
-
-        float alpha = autoBalanceSpeed_ * 0.01f;
         proc.currentGain = proc.currentGain * (1.0f - alpha) + proc.targetGain * alpha;
     }
 }
 
-void MultibandProcessor::process(float* buffer, int numFrames, int numChannels, float sampleRate) {
-    if (!enabled_ || !initialized_) return;
-
-    if (sampleRate != sampleRate_) {
-        init(sampleRate);
+void MultibandProcessor::splitNode(CrossoverNode& xo, float* const* low, float* const* high,
+                                   int numFrames, int numChannels) {
+    for (int ch = 0; ch < numChannels; ch++)
+        std::memcpy(high[ch], low[ch], (size_t)numFrames * sizeof(float));
+    xo.allpass.processBlock(high, numFrames, numChannels);
+    StereoBiquad::processCascade(xo.lowpass, 2, low, numFrames, numChannels);
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* h = high[ch];
+        const float* l = low[ch];
+        for (int i = 0; i < numFrames; i++)
+            h[i] -= l[i];
     }
 
-    if (subBassRangeChanged_) {
-        updateFilters();
-    }
+    StereoBiquad::processCascade(xo.lowCompensation, xo.lastBand - xo.splitBand - 1,
+                                 low, numFrames, numChannels);
+    StereoBiquad::processCascade(xo.highCompensation, xo.splitBand - xo.firstBand,
+                                 high, numFrames, numChannels);
+}
 
-    analyzer_.process(buffer, numFrames, numChannels);
-    updateAutoBalance();
+void MultibandProcessor::splitBands(int numFrames, int numChannels) {
+    for (int ch = 0; ch < numChannels; ch++)
+        std::memcpy(bandBuffers_[0][ch], block_.channels[ch], (size_t)numFrames * sizeof(float));
 
-    std::array<std::vector<float>, NUM_BANDS> bandBuffers;
-    for (int b = 0; b < NUM_BANDS; b++) {
-        bandBuffers[b].resize(numFrames * numChannels, 0.0f);
+    for (auto& xo : crossovers_) {
+        // In multirate mode the low branch is split after decimation
+        if (multirate_ && xo.lastBand < LOW_RATE_BANDS) continue;
+        splitNode(xo, bandBuffers_[xo.firstBand], bandBuffers_[xo.splitBand + 1], numFrames, numChannels);
     }
+}
 
-    auto processBand = [&](int b) {
-        if (!bands_[b].enabled) return;
+void MultibandProcessor::compressBands(CompressorBank& bank, float* const* const* lanes, int numBands,
+                                       int numFrames, int numChannels, float sampleRate) {
+    float laneGains[NUM_BANDS];
+    for (int b = 0; b < numBands; b++)
+        laneGains[b] = processors_[b].currentGain;
+    laneGains[0] *= subBassBoostLinear_;
 
-        auto& proc = processors_[b];
+    bank.updateParams(bandCompSettings_, sampleRate);
+    bank.process(lanes, laneGains, numFrames, numChannels);
+}
 
-        std::memcpy(bandBuffers[b].data(), buffer, numFrames * numChannels * sizeof(float));
+void MultibandProcessor::processLowRate() {
+    LowRatePath& path = lowRate_;
+    int numFrames = block_.numFrames;
+    int nCh = block_.numChannels;
+
+    // bandBuffers_[0] holds the whole branch below bands_[1].highFreq
+    const float* const* in = bandBuffers_[0];
+    int frames = numFrames;
+    for (int s = 0; s < path.numStages; s++) {
+        float** out = path.stageBuffers[s & 1];
+        frames = path.decimators[s].process(in, frames, out);
+        in = out;
+    }
 
-        for (int i = 0; i < numFrames; i++) {
-            float L = bandBuffers[b][i * numChannels];
-            L = proc.hpfL.process(L);
-            L = proc.lpfL.process(L);
-            bandBuffers[b][i * numChannels] = L;
-
-            if (numChannels > 1) {
-                float R = bandBuffers[b][i * numChannels + 1];
-                R = proc.hpfR.process(R);
-                R = proc.lpfR.process(R);
-                bandBuffers[b][i * numChannels + 1] = R;
-            }
+    float** low = path.bands[0];
+    float** high = path.bands[1];
+    size_t bytes = (size_t)frames * sizeof(float);
+    for (int ch = 0; ch < nCh; ch++)
+        std::memcpy(low[ch], in[ch], bytes);
+    splitNode(path.split, low, high, frames, nCh);
+
+    if (bands_[0].enabled)
+        path.subsonicFilter.processBlock(low, frames, nCh);
+    float* const* lanes[LOW_RATE_BANDS] = { bands_[0].enabled ? low : nullptr,
+                                            bands_[1].enabled ? high : nullptr };
+    compressBands(path.compressors, lanes, LOW_RATE_BANDS, frames, nCh, path.sampleRate);
+
+    for (int ch = 0; ch < nCh; ch++) {
+        if (!bands_[0].enabled)
+            std::memset(low[ch], 0, bytes);
+        if (bands_[1].enabled) {
+            for (int i = 0; i < frames; i++)
+                low[ch][i] += high[ch][i];
         }
+    }
 
-        CompressorParams compParams;
-        float ratio = 1.0f + (globalCompression_ * 3.0f);
-        compParams.ratio.store(ratio, std::memory_order_relaxed);
-        compParams.thresholdDb.store(-12.0f, std::memory_order_relaxed);
-        compParams.attackMs.store(5.0f, std::memory_order_relaxed);
-        compParams.releaseMs.store(50.0f, std::memory_order_relaxed);
-        compParams.kneeDb.store(3.0f, std::memory_order_relaxed);
-        compParams.enabled.store(globalCompression_ > 0.01f, std::memory_order_relaxed);
+    // Back up to the full rate, behind what the last block left over
+    for (int ch = 0; ch < nCh; ch++)
+        path.queued[ch] = path.output[ch] + path.outputFrames;
+    const float* const* src = low;
+    if (path.numStages == 0) {
+        for (int ch = 0; ch < nCh; ch++)
+            std::memcpy(path.queued[ch], low[ch], bytes);
+    }
+    for (int s = path.numStages - 1; s >= 0; s--) {
+        float** out = (s == 0) ? path.queued : path.stageBuffers[s & 1];
+        path.interpolators[s].process(src, frames, out);
+        frames *= 2;
+        src = out;
+    }
+    path.outputFrames += frames;
 
-        proc.compressor.updateParams(compParams, sampleRate);
-        proc.compressor.process(bandBuffers[b].data(), numFrames, numChannels);
+    path.outputFrames -= numFrames;
+    for (int ch = 0; ch < nCh; ch++) {
+        std::memcpy(bandBuffers_[0][ch], path.output[ch], (size_t)numFrames * sizeof(float));
+        std::memmove(path.output[ch], path.output[ch] + numFrames,
+                     (size_t)path.outputFrames * sizeof(float));
+    }
+}
 
-        float gain = proc.currentGain;
+void MultibandProcessor::delayHighBands(float* const* channels, int numFrames, int numChannels) {
+    LowRatePath& path = lowRate_;
+    int length = path.latency;
+    if (length == 0) return;
 
-        if (b == 0) {
-            gain *= dsp::dbToLinear(subBassBoostDb_);
+    int pos = path.highDelayPos;
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* line = path.highDelay[ch];
+        float* samples = channels[ch];
+        pos = path.highDelayPos;
+        for (int i = 0; i < numFrames; i++) {
+            float delayed = line[pos];
+            line[pos] = samples[i];
+            samples[i] = delayed;
+            if (++pos == length) pos = 0;
         }
+    }
+    path.highDelayPos = pos;
+}
 
-        for (int i = 0; i < numFrames * numChannels; i++) {
-            bandBuffers[b][i] *= gain;
-        }
-    };
+void MultibandProcessor::process(float* const* channels, int numFrames, int numChannels, float sampleRate) {
+    if (!enabled_ || !initialized_) return;
+    if (numFrames > maxBlockFrames_ || numChannels > maxChannels_ || sampleRate != sampleRate_) return;
 
-    std::thread t1([&]() { for (int b = 0; b < 3; b++) processBand(b); });
-    std::thread t2([&]() { for (int b = 3; b < 6; b++) processBand(b); });
-    std::thread t3([&]() { for (int b = 6; b < 9; b++) processBand(b); });
+    if (subBassRangeChanged_) {
+        updateFilters();
+    }
 
-    t1.join();
-    t2.join();
-    t3.join();
+    analyzer_.push(channels, numFrames, numChannels);
+    updateAutoBalance(numFrames);
 
-    std::memset(buffer, 0, numFrames * numChannels * sizeof(float));
-    for (int b = 0; b < (int)bands_.size(); b++) {
-        if (!bands_[b].enabled) continue;
+    block_.channels = channels;
+    block_.numFrames = numFrames;
+    block_.numChannels = numChannels;
+    block_.sampleRate = sampleRate;
 
-        for (int i = 0; i < numFrames * numChannels; i++) {
-            buffer[i] += bandBuffers[b][i];
+    splitBands(numFrames, numChannels);
+    if (multirate_)
+        processLowRate();
+
+    // Every band still at the full rate is a lane of one compressor pass
+    float* const* lanes[NUM_BANDS];
+    for (int b = 0; b < NUM_BANDS; b++) {
+        bool fullRate = !(multirate_ && b < LOW_RATE_BANDS);
+        lanes[b] = (fullRate && bands_[b].enabled) ? bandBuffers_[b] : nullptr;
+    }
+    if (lanes[0])
+        subsonicFilter_.processBlock(lanes[0], numFrames, numChannels);
+    compressBands(bandCompressors_, lanes, NUM_BANDS, numFrames, numChannels, sampleRate);
+
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* out = channels[ch];
+        std::memset(out, 0, (size_t)numFrames * sizeof(float));
+        for (int b = 0; b < NUM_BANDS; b++) {
+            if (multirate_ && b < LOW_RATE_BANDS) continue;
+            if (!bands_[b].enabled) continue;
+
+            const float* band = bandBuffers_[b][ch];
+            for (int i = 0; i < numFrames; i++)
+                out[i] += band[i];
         }
     }
 
-    exciter_.process(buffer, numFrames, numChannels);
-
-    outputGainLinear_ = dsp::dbToLinear(outputGainDb_);
-    for (int i = 0; i < numFrames * numChannels; i++) {
-        buffer[i] *= outputGainLinear_;
+    if (multirate_) {
+        delayHighBands(channels, numFrames, numChannels);
+        for (int ch = 0; ch < numChannels; ch++) {
+            float* out = channels[ch];
+            const float* low = bandBuffers_[0][ch];
+            for (int i = 0; i < numFrames; i++)
+                out[i] += low[i];
+        }
     }
+
+    exciter_.process(channels, numFrames, numChannels);
+
+    const dsp::Kernels& k = dsp::kernels();
+    for (int ch = 0; ch < numChannels; ch++)
+        k.applyGain(channels[ch], (size_t)numFrames, outputGainLinear_);
+}
+
+float MultibandProcessor::getBandGainReduction(int idx) const {
+    if (!enabled_ || !bands_[idx].enabled) return 0.0f;
+    if (multirate_ && idx < LOW_RATE_BANDS)
+        return lowRate_.compressors.getGainReduction(idx);
+    return bandCompressors_.getGainReduction(idx);
 }
 
 void MultibandProcessor::reset() {
+    for (auto& xo : crossovers_) {
+        xo.lowpass[0].reset();
+        xo.lowpass[1].reset();
+        xo.allpass.reset();
+        for (auto& ap : xo.lowCompensation) ap.reset();
+        for (auto& ap : xo.highCompensation) ap.reset();
+    }
+    subsonicFilter_.reset();
+    resetLowRate();
+    bandCompressors_.reset();
     for (auto& proc : processors_) {
-        proc.hpfL.reset();
-        proc.hpfR.reset();
-        proc.lpfL.reset();
-        proc.lpfR.reset();
-        proc.compressor.reset();
         proc.currentGain = 1.0f;
         proc.targetGain = 1.0f;
     }
     analyzer_.reset();
     exciter_.reset();
 }
+
+void MultibandProcessor::resetLowRate() {
+    LowRatePath& path = lowRate_;
+    for (int s = 0; s < path.numStages; s++) {
+        path.decimators[s].reset();
+        path.interpolators[s].reset();
+    }
+    path.split.lowpass[0].reset();
+    path.split.lowpass[1].reset();
+    path.split.allpass.reset();
+    path.subsonicFilter.reset();
+    path.compressors.reset();
+
+    path.outputFrames = 0;
+    path.highDelayPos = 0;
+    if (path.highDelay) {
+        for (int ch = 0; ch < maxChannels_; ch++)
+            std::memset(path.highDelay[ch], 0, (size_t)std::max(1, path.latency) * sizeof(float));
+    }
+}
@@ -1,13 +1,13 @@
 #pragma once
 #include "biquad.h"
-#include "compressor.h"
+#include "compressor_bank.h"
 #include "spectral_analyzer.h"
 #include "exciter.h"
+#include "halfband.h"
+#include "scratch_arena.h"
 #include <vector>
 #include <array>
 #include <atomic>
-#include <thread>
-#include <mutex>
 
 struct MultibandBand {
     float lowFreq;
@@ -24,45 +24,130 @@ public:
     MultibandProcessor();
 
     void init(float sampleRate);
-    void process(float* buffer, int numFrames, int numChannels, float sampleRate);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void process(float* const* channels, int numFrames, int numChannels, float sampleRate);
 
     void setEnabled(bool enabled) { enabled_ = enabled; }
     void setAutoBalance(bool enable) { autoBalance_ = enable; }
     void setAutoBalanceSpeed(float speed) { autoBalanceSpeed_ = speed; }
-    void setGlobalCompression(float amount) { globalCompression_ = amount; }
-    void setOutputGain(float gainDb) { outputGainDb_ = gainDb; }
-    void setSubBassBoost(float boostDb) { subBassBoostDb_ = boostDb; }
+    void setGlobalCompression(float amount);
+    void setOutputGain(float gainDb);
+    void setSubBassBoost(float boostDb);
+    void setExciterAmount(float amount) { exciter_.setAmount(amount); }
     void setSubBassRange(float lowFreq, float highFreq);
+    void setMultirate(bool enable);
+    // See SpectralAnalyzer::setBackground; takes effect at the next prepare()
+    void setBackgroundAnalysis(bool enable) { analyzer_.setBackground(enable); }
+    // Audio thread: the background analysis thread runs only while this is
+    // on. Off after prepare().
+    void setAnalysisRunning(bool run) { if (run) analyzer_.start(); else analyzer_.stop(); }
 
     int getNumBands() const { return (int)bands_.size(); }
     MultibandBand& getBand(int idx) { return bands_[idx]; }
     const MultibandBand& getBand(int idx) const { return bands_[idx]; }
 
+    // Delay the multirate low bands add, in samples; 0 when multirate is off
+    int getLatencySamples() const { return latencySamples_.load(std::memory_order_relaxed); }
+
+    // Audio thread: the band compressor's reduction over the last block
+    float getBandGainReduction(int idx) const;
+
     void reset();
 
 private:
+    static constexpr int NUM_BANDS = 9;
+    static constexpr int NUM_CROSSOVERS = NUM_BANDS - 1;
+    // Multirate: bands below LOW_RATE_BANDS run decimated by up to
+    // 2^MAX_RATE_STAGES, as far as the rate stays above LOW_RATE_MARGIN
+    // times their upper edge
+    static constexpr int LOW_RATE_BANDS = 2;
+    static constexpr int MAX_RATE_STAGES = 4;
+    static constexpr float LOW_RATE_MARGIN = 10.0f;
+    // Auto-balance moves autoBalanceSpeed percent of the way to its target
+    // per this many frames, whatever size the blocks come in
+    static constexpr float AUTO_BALANCE_FRAMES = 1024.0f;
+
     struct BandProcessor {
-        Biquad lpfL, lpfR;
-        Biquad hpfL, hpfR;
-        Compressor compressor;
         float currentGain = 1.0f;
         float targetGain = 1.0f;
+    };
 
-        BandProcessor() = default;
-        BandProcessor(const BandProcessor&) = delete;
-        BandProcessor& operator=(const BandProcessor&) = delete;
-        BandProcessor(BandProcessor&&) = delete;
-        BandProcessor& operator=(BandProcessor&&) = delete;
+    // One Linkwitz-Riley (LR4) split of the tree. The node's input sits in
+    // bandBuffers_[firstBand]; the lowpass stays there and the highpass goes
+    // to bandBuffers_[splitBand + 1]. Each branch then passes through the
+    // allpass of every crossover in the other branch, so both carry the same
+    // phase and the nine bands add back up to an allpass of the input.
+    struct CrossoverNode {
+        int firstBand = 0;
+        int splitBand = 0;
+        int lastBand = 0;
+        StereoBiquad lowpass[2];
+        StereoBiquad allpass;
+        StereoBiquad lowCompensation[NUM_CROSSOVERS];
+        StereoBiquad highCompensation[NUM_CROSSOVERS];
     };
 
+    // Bands 0 and 1 in multirate mode. Their branch of the crossover tree is
+    // decimated, split and compressed at the low rate, then interpolated back
+    // and queued; interpolation runs ahead by up to one low-rate frame, which
+    // waits in output for the next block. The other bands go through
+    // highDelay so they line up with the resampling delay. Every buffer is a
+    // planar block with one array per channel.
+    struct LowRatePath {
+        HalfbandDecimator decimators[MAX_RATE_STAGES];
+        HalfbandInterpolator interpolators[MAX_RATE_STAGES];
+        CrossoverNode split;
+        StereoBiquad subsonicFilter;
+        CompressorBank compressors;
+        int numStages = 0;
+        float sampleRate = 0.0f;
+        int latency = 0;
+
+        float** stageBuffers[2] = {};
+        float** bands[LOW_RATE_BANDS] = {};
+        float** output = nullptr;
+        // output, each channel advanced past the outputFrames already queued
+        float** queued = nullptr;
+        int outputFrames = 0;
+        float** highDelay = nullptr;
+        int highDelayPos = 0;
+    };
+
+    struct BlockContext {
+        float* const* channels = nullptr;
+        int numFrames = 0;
+        int numChannels = 0;
+        float sampleRate = 0.0f;
+    };
+
+    int buildCrossoverTree(int firstBand, int lastBand, int node);
+    void splitNode(CrossoverNode& xo, float* const* low, float* const* high, int numFrames, int numChannels);
+    void splitBands(int numFrames, int numChannels);
+    void compressBands(CompressorBank& bank, float* const* const* lanes, int numBands,
+                       int numFrames, int numChannels, float sampleRate);
+    void processLowRate();
+    void delayHighBands(float* const* channels, int numFrames, int numChannels);
+    void resetLowRate();
     void updateFilters();
-    void updateAutoBalance();
+    void updateAutoBalance(int numFrames);
 
-    static constexpr int NUM_BANDS = 9;
     std::vector<MultibandBand> bands_;
     std::array<BandProcessor, NUM_BANDS> processors_;
+    // All bands' compressors as lanes of one bank
+    CompressorBank bandCompressors_;
+    // Pre-order, so every node's input is ready once the ones before it ran
+    std::array<CrossoverNode, NUM_CROSSOVERS> crossovers_;
+    // Rumble cut at the bottom edge of the sub-bass band
+    StereoBiquad subsonicFilter_;
+    LowRatePath lowRate_;
+    bool multirate_ = false;
+    std::atomic<int> latencySamples_{0};
     SpectralAnalyzer analyzer_;
     Exciter exciter_;
+    BlockContext block_;
+    float** bandBuffers_[NUM_BANDS] = {};
+    int maxBlockFrames_ = 0;
+    int maxChannels_ = 0;
 
     float sampleRate_ = 48000.0f;
     bool enabled_ = true;
@@ -72,6 +157,8 @@ private:
     float outputGainDb_ = 0.0f;
     float outputGainLinear_ = 1.0f;
     float subBassBoostDb_ = 10.0f;
+    float subBassBoostLinear_ = 1.0f;
+    CompressorSettings bandCompSettings_;
     float subBassLowFreq_ = 30.0f;
     float subBassHighFreq_ = 250.0f;
     bool subBassRangeChanged_ = false;
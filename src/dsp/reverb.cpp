@@ -3,6 +3,14 @@
 #include <cstring>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REVERB_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define REVERB_NEON 1
+#endif
+
 // Prime delay lengths tuned for 48kHz, spread across 23-47ms for rich, dense tail
 static const int COMB_TUNING_48K[12] = {
     1117, 1201, 1301, 1399, 1499, 1601,
@@ -15,30 +23,156 @@ static const int INPUT_AP_TUNING_48K[4] = { 163, 271, 383, 503 };
 // Output decorrelation allpass lengths
 static const int OUTPUT_AP_TUNING_48K[2] = { 131, 197 };
 
-void Reverb::CombFilter::init(int sz) {
-    size = sz;
-    buffer.assign(sz, 0.0f);
-    idx = 0;
-    filterState = 0.0f;
+// FDN line lengths, primes spaced geometrically over 24-52ms (8 lines) and
+// 21-58ms (16 lines) so no two lines share a resonance
+static const int FDN8_TUNING_48K[8] = {
+    1153, 1289, 1439, 1607, 1801, 2003, 2237, 2503
+};
+static const int FDN16_TUNING_48K[16] = {
+    1009, 1087, 1163, 1237, 1321, 1423, 1523, 1619,
+    1733, 1861, 1987, 2129, 2273, 2437, 2609, 2789
+};
+
+namespace {
+
+// Orthonormal Walsh-Hadamard transform of n (8 or 16) floats in place. The
+// two innermost butterfly stages stay inside one register, the rest run
+// across registers.
+#if defined(REVERB_SSE)
+inline __m128 hadamard4(__m128 x) {
+    __m128 sw = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+    x = _mm_add_ps(sw, _mm_mul_ps(x, _mm_set_ps(-1.0f, 1.0f, -1.0f, 1.0f)));
+    sw = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_ps(sw, _mm_mul_ps(x, _mm_set_ps(-1.0f, -1.0f, 1.0f, 1.0f)));
 }
 
-float Reverb::CombFilter::process(float input, float feedback, float damping) {
-    float output = buffer[idx];
-    filterState = output + damping * (filterState - output);
-    buffer[idx] = input + filterState * feedback;
-    if (++idx >= size) idx = 0;
-    return output;
+void hadamard(float* v, int n) {
+    __m128 r[4];
+    int nr = n / 4;
+    for (int k = 0; k < nr; k++)
+        r[k] = hadamard4(_mm_load_ps(v + 4 * k));
+    for (int h = 1; h < nr; h <<= 1) {
+        for (int i = 0; i < nr; i += 2 * h) {
+            for (int j = i; j < i + h; j++) {
+                __m128 a = r[j], b = r[j + h];
+                r[j] = _mm_add_ps(a, b);
+                r[j + h] = _mm_sub_ps(a, b);
+            }
+        }
+    }
+    __m128 norm = _mm_set1_ps(1.0f / std::sqrt((float)n));
+    for (int k = 0; k < nr; k++)
+        _mm_store_ps(v + 4 * k, _mm_mul_ps(r[k], norm));
+}
+
+// Output taps (even lines left, odd right), then one-pole damping and decay
+// gain applied to the line outputs in place.
+void tapAndDamp(float* v, float* state, const float* damp, const float* gain,
+                const float* outGain, int n, float& outL, float& outR) {
+    __m128 taps = _mm_setzero_ps();
+    for (int k = 0; k < n; k += 4) {
+        __m128 x = _mm_load_ps(v + k);
+        taps = _mm_add_ps(taps, _mm_mul_ps(x, _mm_load_ps(outGain + k)));
+        __m128 s = _mm_load_ps(state + k);
+        s = _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(damp + k), _mm_sub_ps(s, x)));
+        _mm_store_ps(state + k, s);
+        _mm_store_ps(v + k, _mm_mul_ps(s, _mm_load_ps(gain + k)));
+    }
+    __m128 hi = _mm_movehl_ps(taps, taps);
+    taps = _mm_add_ps(taps, hi);
+    outL = _mm_cvtss_f32(taps);
+    outR = _mm_cvtss_f32(_mm_shuffle_ps(taps, taps, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+#elif defined(REVERB_NEON)
+inline float32x4_t hadamard4(float32x4_t x) {
+    static const float s1[4] = { 1.0f, -1.0f, 1.0f, -1.0f };
+    static const float s2[4] = { 1.0f, 1.0f, -1.0f, -1.0f };
+    float32x4_t sw = vrev64q_f32(x);
+    x = vmlaq_f32(sw, x, vld1q_f32(s1));
+    sw = vextq_f32(x, x, 2);
+    return vmlaq_f32(sw, x, vld1q_f32(s2));
+}
+
+void hadamard(float* v, int n) {
+    float32x4_t r[4];
+    int nr = n / 4;
+    for (int k = 0; k < nr; k++)
+        r[k] = hadamard4(vld1q_f32(v + 4 * k));
+    for (int h = 1; h < nr; h <<= 1) {
+        for (int i = 0; i < nr; i += 2 * h) {
+            for (int j = i; j < i + h; j++) {
+                float32x4_t a = r[j], b = r[j + h];
+                r[j] = vaddq_f32(a, b);
+                r[j + h] = vsubq_f32(a, b);
+            }
+        }
+    }
+    float norm = 1.0f / std::sqrt((float)n);
+    for (int k = 0; k < nr; k++)
+        vst1q_f32(v + 4 * k, vmulq_n_f32(r[k], norm));
+}
+
+void tapAndDamp(float* v, float* state, const float* damp, const float* gain,
+                const float* outGain, int n, float& outL, float& outR) {
+    float32x4_t taps = vdupq_n_f32(0.0f);
+    for (int k = 0; k < n; k += 4) {
+        float32x4_t x = vld1q_f32(v + k);
+        taps = vmlaq_f32(taps, x, vld1q_f32(outGain + k));
+        float32x4_t s = vld1q_f32(state + k);
+        s = vmlaq_f32(x, vld1q_f32(damp + k), vsubq_f32(s, x));
+        vst1q_f32(state + k, s);
+        vst1q_f32(v + k, vmulq_f32(s, vld1q_f32(gain + k)));
+    }
+    float32x2_t pair = vadd_f32(vget_low_f32(taps), vget_high_f32(taps));
+    outL = vget_lane_f32(pair, 0);
+    outR = vget_lane_f32(pair, 1);
+}
+#else
+void hadamard(float* v, int n) {
+    for (int h = 1; h < n; h <<= 1) {
+        for (int i = 0; i < n; i += 2 * h) {
+            for (int j = i; j < i + h; j++) {
+                float a = v[j], b = v[j + h];
+                v[j] = a + b;
+                v[j + h] = a - b;
+            }
+        }
+    }
+    float norm = 1.0f / std::sqrt((float)n);
+    for (int i = 0; i < n; i++) v[i] *= norm;
+}
+
+void tapAndDamp(float* v, float* state, const float* damp, const float* gain,
+                const float* outGain, int n, float& outL, float& outR) {
+    outL = 0.0f;
+    outR = 0.0f;
+    for (int i = 0; i < n; i += 2) {
+        outL += v[i] * outGain[i];
+        outR += v[i + 1] * outGain[i + 1];
+    }
+    for (int i = 0; i < n; i++) {
+        state[i] = v[i] + damp[i] * (state[i] - v[i]);
+        v[i] = state[i] * gain[i];
+    }
+}
+#endif
+
+} // namespace
+
+void Reverb::CombFilter::init(int sz, ScratchArena& arena) {
+    size = sz;
+    buffer = arena.allocate<float>(sz);
+    idx = 0;
 }
 
 void Reverb::CombFilter::reset() {
-    std::fill(buffer.begin(), buffer.end(), 0.0f);
-    filterState = 0.0f;
+    std::fill(buffer, buffer + size, 0.0f);
     idx = 0;
 }
 
-void Reverb::AllpassFilter::init(int sz) {
+void Reverb::AllpassFilter::init(int sz, ScratchArena& arena) {
     size = sz;
-    buffer.assign(sz, 0.0f);
+    buffer = arena.allocate<float>(sz);
     idx = 0;
 }
 
@@ -50,13 +184,13 @@ float Reverb::AllpassFilter::process(float input, float feedback) {
 }
 
 void Reverb::AllpassFilter::reset() {
-    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    std::fill(buffer, buffer + size, 0.0f);
     idx = 0;
 }
 
-void Reverb::DelayLine::init(int maxSamples) {
+void Reverb::DelayLine::init(int maxSamples, ScratchArena& arena) {
     size = maxSamples;
-    buffer.assign(maxSamples, 0.0f);
+    buffer = arena.allocate<float>(maxSamples);
     writeIdx = 0;
     readIdx = 0;
 }
@@ -77,37 +211,51 @@ float Reverb::DelayLine::process(float input) {
 }
 
 void Reverb::DelayLine::reset() {
-    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    std::fill(buffer, buffer + size, 0.0f);
 }
 
 Reverb::Reverb() = default;
 
-void Reverb::init(float sampleRate) {
+void Reverb::prepare(float sampleRate, int /*maxBlockFrames*/, int /*numChannels*/, ScratchArena& arena) {
     sampleRate_ = sampleRate;
     float scale = sampleRate / 48000.0f;
 
+    combTile_ = COMB_TILE;
     for (int i = 0; i < NUM_COMBS; i++) {
         int sz = std::max(1, (int)(COMB_TUNING_48K[i] * scale));
-        combL_[i].init(sz);
-        combR_[i].init(sz + STEREO_SPREAD);
+        combL_[i].init(sz, arena);
+        combR_[i].init(sz + STEREO_SPREAD, arena);
+        combTile_ = std::min(combTile_, sz);
     }
 
     for (int i = 0; i < NUM_INPUT_AP; i++) {
         int sz = std::max(1, (int)(INPUT_AP_TUNING_48K[i] * scale));
-        inputApL_[i].init(sz);
-        inputApR_[i].init(sz + 13);
+        inputApL_[i].init(sz, arena);
+        inputApR_[i].init(sz + 13, arena);
     }
 
     for (int i = 0; i < NUM_OUTPUT_AP; i++) {
         int sz = std::max(1, (int)(OUTPUT_AP_TUNING_48K[i] * scale));
-        outputApL_[i].init(sz);
-        outputApR_[i].init(sz + 11);
+        outputApL_[i].init(sz, arena);
+        outputApR_[i].init(sz + 11, arena);
+    }
+
+    int fdnMaxDelay = (int)(std::max(FDN8_TUNING_48K[7], FDN16_TUNING_48K[15]) * scale);
+    int fdnFrames = 1;
+    while (fdnFrames <= fdnMaxDelay) fdnFrames <<= 1;
+    fdnData_ = arena.allocate<float>((size_t)fdnFrames * MAX_FDN_LINES);
+    fdnMask_ = fdnFrames - 1;
+    fdnWritePos_ = 0;
+    for (int i = 0; i < MAX_FDN_LINES; i++) {
+        fdnDelay_[i] = 1;
+        fdnState_[i] = 0.0f;
     }
+    algorithm_ = ReverbAlgorithm::Freeverb;
 
     int maxDelay = std::max(1, (int)(sampleRate * 0.15f));
-    preDelay_.init(maxDelay);
-    lateDelayL_.init(maxDelay);
-    lateDelayR_.init(maxDelay);
+    preDelay_.init(maxDelay, arena);
+    lateDelayL_.init(maxDelay, arena);
+    lateDelayR_.init(maxDelay, arena);
 
     inputHPF_.setParams(Biquad::Type::HighPass, 90.0f, 0.0f, 0.707f, sampleRate);
     inputLPF_.setParams(Biquad::Type::LowPass, 11000.0f, 0.0f, 0.707f, sampleRate);
@@ -118,19 +266,59 @@ void Reverb::init(float sampleRate) {
     }
     combNorm_ = 1.0f / std::sqrt((float)NUM_COMBS);
 
+    lastDecayTime_ = -1.0f;
+    lastHiRatio_ = -1.0f;
+    lastDiffusion_ = -1.0f;
+    lastDensity_ = -1.0f;
+    lastLpfFreq_ = -1.0f;
+    lastHpfFreq_ = -1.0f;
+    lastVersion_ = ~0u;
+
+    // The input filters live outside the arena and would otherwise carry
+    // state over from the previous stream
+    reset();
     initialized_ = true;
 }
 
-void Reverb::updateParams(const ReverbParams& params) {
-    float decayTime  = params.decayTime.load(std::memory_order_relaxed);
-    float hiRatio    = params.hiRatio.load(std::memory_order_relaxed);
-    float diffusion  = params.diffusion.load(std::memory_order_relaxed);
-    float initDelay  = params.initialDelay.load(std::memory_order_relaxed);
-    float density    = params.density.load(std::memory_order_relaxed);
-    float lpfFreq    = params.lpfFreq.load(std::memory_order_relaxed);
-    float hpfFreq    = params.hpfFreq.load(std::memory_order_relaxed);
-    float revDelay   = params.reverbDelay.load(std::memory_order_relaxed);
-    float balance    = params.balance.load(std::memory_order_relaxed);
+void Reverb::updateParams(const ReverbSettings& settings) {
+    if (settings.version == lastVersion_) return;
+    lastVersion_ = settings.version;
+
+    float decayTime  = settings.decayTime;
+    float hiRatio    = settings.hiRatio;
+    float diffusion  = settings.diffusion;
+    float initDelay  = settings.initialDelay;
+    float density    = settings.density;
+    float lpfFreq    = settings.lpfFreq;
+    float hpfFreq    = settings.hpfFreq;
+    float revDelay   = settings.reverbDelay;
+    float balance    = settings.balance;
+
+    ReverbAlgorithm algorithm = (ReverbAlgorithm)std::max(0, std::min(2, settings.algorithm));
+    if (algorithm != algorithm_) {
+        algorithm_ = algorithm;
+        if (algorithm_ != ReverbAlgorithm::Freeverb) {
+            const int* tuning = (algorithm_ == ReverbAlgorithm::FDN16) ? FDN16_TUNING_48K : FDN8_TUNING_48K;
+            fdnLines_ = (algorithm_ == ReverbAlgorithm::FDN16) ? 16 : 8;
+            float scale = sampleRate_ / 48000.0f;
+            for (int i = 0; i < fdnLines_; i++)
+                fdnDelay_[i] = std::max(1, (int)(tuning[i] * scale));
+            resetFDN();
+            // Line lengths changed, so the per-line gains must be rebuilt
+            lastDecayTime_ = -1.0f;
+            lastHiRatio_ = -1.0f;
+            lastDensity_ = -1.0f;
+        }
+    }
+
+    if (algorithm_ != ReverbAlgorithm::Freeverb &&
+        (decayTime != lastDecayTime_ || hiRatio != lastHiRatio_)) {
+        updateFDNDecay(decayTime, hiRatio);
+    }
+
+    if (algorithm_ != ReverbAlgorithm::Freeverb && density != lastDensity_) {
+        updateFDNTaps(density);
+    }
 
     if (decayTime != lastDecayTime_) {
         float rt60 = std::max(0.1f, decayTime);
@@ -193,24 +381,66 @@ void Reverb::updateParams(const ReverbParams& params) {
     dry_ = 1.0f - bal * 0.5f;
 }
 
-void Reverb::process(float* buffer, int numFrames, int numChannels) {
-    if (!initialized_) return;
+void Reverb::updateFDNDecay(float decayTime, float hiRatio) {
+    float rt60 = std::max(0.1f, decayTime);
+    // hiRatio is the high-frequency RT60 as a fraction of the low one
+    float rt60Hi = rt60 * std::max(0.05f, std::min(1.0f, hiRatio));
+
+    for (int i = 0; i < fdnLines_; i++) {
+        float delaySec = (float)fdnDelay_[i] / sampleRate_;
+        float gLow = std::pow(10.0f, -3.0f * delaySec / rt60);
+        float gHigh = std::pow(10.0f, -3.0f * delaySec / rt60Hi);
+        // One-pole lowpass whose Nyquist gain brings gLow down to gHigh
+        float r = gHigh / gLow;
+        fdnGain_[i] = gLow;
+        fdnDamp_[i] = (1.0f - r) / (1.0f + r);
+    }
+}
+
+void Reverb::updateFDNTaps(float density) {
+    // Same weighting as the comb bank: the shortest lines are always heard,
+    // longer ones fade in with density
+    float d = std::max(0.0f, std::min(12.0f, density)) / 12.0f;
+    float sumSq = 0.0f;
+    for (int i = 0; i < fdnLines_; i++) {
+        int rank = i * 3 / fdnLines_;
+        if (rank == 0)
+            fdnOutGain_[i] = 1.0f;
+        else if (rank == 1)
+            fdnOutGain_[i] = 0.3f + 0.7f * d;
+        else
+            fdnOutGain_[i] = 0.1f + 0.9f * d * d;
+        sumSq += fdnOutGain_[i] * fdnOutGain_[i];
+    }
+    // Each output only sums half the lines
+    float norm = 1.0f / std::sqrt(0.5f * sumSq);
+    for (int i = 0; i < fdnLines_; i++)
+        fdnOutGain_[i] *= norm;
+}
 
-    int channels = std::min(numChannels, 2);
+void Reverb::resetFDN() {
+    if (fdnData_)
+        std::fill(fdnData_, fdnData_ + (size_t)(fdnMask_ + 1) * MAX_FDN_LINES, 0.0f);
+    fdnWritePos_ = 0;
+    for (int i = 0; i < MAX_FDN_LINES; i++)
+        fdnState_[i] = 0.0f;
+}
 
-    for (int frame = 0; frame < numFrames; frame++) {
-        int idxL = frame * numChannels;
-        int idxR = (channels > 1) ? (frame * numChannels + 1) : idxL;
+template<int N>
+void Reverb::processFDN(float* left, float* right, int numFrames) {
+    bool stereo = (right != left);
+    alignas(16) float v[N];
 
-        float inputL = buffer[idxL];
-        float inputR = buffer[idxR];
+    for (int frame = 0; frame < numFrames; frame++) {
+        float inputL = left[frame];
+        float inputR = right[frame];
 
         float mono = (inputL + inputR) * 0.5f;
 
         float filtered = inputHPF_.process(mono);
         filtered = inputLPF_.process(filtered);
 
-        float pd = preDelay_.process(filtered) * INPUT_GAIN;
+        float pd = preDelay_.process(filtered) * FDN_INPUT_GAIN;
 
         float diffL = pd;
         float diffR = pd;
@@ -222,28 +452,125 @@ void Reverb::process(float* buffer, int numFrames, int numChannels) {
         float delL = lateDelayL_.process(diffL);
         float delR = lateDelayR_.process(diffR);
 
-        float outL = 0.0f, outR = 0.0f;
-        for (int i = 0; i < NUM_COMBS; i++) {
-            float g = combGain_[i];
-            outL += combL_[i].process(delL, combFeedback_[i], damping_) * g;
-            outR += combR_[i].process(delR, combFeedback_[i], damping_) * g;
+        for (int i = 0; i < N; i++)
+            v[i] = fdnData_[((fdnWritePos_ - fdnDelay_[i]) & fdnMask_) * MAX_FDN_LINES + i];
+
+        float outL, outR;
+        tapAndDamp(v, fdnState_, fdnDamp_, fdnGain_, fdnOutGain_, N, outL, outR);
+        hadamard(v, N);
+
+        // Alternate input polarity per line pair so both channels excite
+        // every mode
+        float* dst = fdnData_ + (size_t)fdnWritePos_ * MAX_FDN_LINES;
+        for (int i = 0; i < N; i += 4) {
+            dst[i]     = v[i]     + delL;
+            dst[i + 1] = v[i + 1] + delR;
+            dst[i + 2] = v[i + 2] - delL;
+            dst[i + 3] = v[i + 3] - delR;
+        }
+        fdnWritePos_ = (fdnWritePos_ + 1) & fdnMask_;
+
+        left[frame] = inputL * dry_ + outL * wet_;
+        if (stereo) {
+            right[frame] = inputR * dry_ + outR * wet_;
+        }
+    }
+}
+
+void Reverb::process(float* const* channels, int numFrames, int numChannels) {
+    if (!initialized_) return;
+
+    float* left = channels[0];
+    float* right = (numChannels > 1) ? channels[1] : left;
+
+    if (algorithm_ == ReverbAlgorithm::FDN16) {
+        processFDN<16>(left, right, numFrames);
+        return;
+    }
+    if (algorithm_ == ReverbAlgorithm::FDN8) {
+        processFDN<8>(left, right, numFrames);
+        return;
+    }
+
+    for (int offset = 0; offset < numFrames; offset += combTile_) {
+        int frames = std::min(combTile_, numFrames - offset);
+        processFreeverb(left + offset, right + offset, frames);
+    }
+}
+
+// One tile in three passes: input diffusion into combIn_, the two comb
+// banks, then output diffusion and the wet/dry mix. The combs only feed
+// forward, so splitting the per-frame loop around them changes nothing.
+void Reverb::processFreeverb(float* left, float* right, int numFrames) {
+    bool stereo = (right != left);
+
+    for (int frame = 0; frame < numFrames; frame++) {
+        float mono = (left[frame] + right[frame]) * 0.5f;
+
+        float filtered = inputHPF_.process(mono);
+        filtered = inputLPF_.process(filtered);
+
+        float pd = preDelay_.process(filtered) * INPUT_GAIN;
+
+        float diffL = pd;
+        float diffR = pd;
+        for (int i = 0; i < NUM_INPUT_AP; i++) {
+            diffL = inputApL_[i].process(diffL, diffusionFb_);
+            diffR = inputApR_[i].process(diffR, diffusionFb_);
         }
 
-        outL *= combNorm_;
-        outR *= combNorm_;
+        combIn_[0][frame] = lateDelayL_.process(diffL);
+        combIn_[1][frame] = lateDelayR_.process(diffR);
+    }
+
+    runCombBank(combL_, combStateL_, combIn_[0], combOut_[0], numFrames);
+    runCombBank(combR_, combStateR_, combIn_[1], combOut_[1], numFrames);
+
+    for (int frame = 0; frame < numFrames; frame++) {
+        float outL = combOut_[0][frame] * combNorm_;
+        float outR = combOut_[1][frame] * combNorm_;
 
         for (int i = 0; i < NUM_OUTPUT_AP; i++) {
             outL = outputApL_[i].process(outL, diffusionFb_ * 0.8f);
             outR = outputApR_[i].process(outR, diffusionFb_ * 0.8f);
         }
 
-        buffer[idxL] = inputL * dry_ + outL * wet_;
-        if (channels > 1) {
-            buffer[idxR] = inputR * dry_ + outR * wet_;
+        float inputL = left[frame];
+        float inputR = right[frame];
+        left[frame] = inputL * dry_ + outL * wet_;
+        if (stereo) {
+            right[frame] = inputR * dry_ + outR * wet_;
         }
     }
 }
 
+void Reverb::runCombBank(CombFilter* combs, float* state, const float* input, float* output,
+                         int numFrames) {
+    // Gather: column i of the tile is the next numFrames samples of line i
+    for (int i = 0; i < NUM_COMBS; i++) {
+        CombFilter& c = combs[i];
+        int first = std::min(numFrames, c.size - c.idx);
+        for (int t = 0; t < first; t++)
+            combTaps_[t * dsp::COMB_BANK_LANES + i] = c.buffer[c.idx + t];
+        for (int t = first; t < numFrames; t++)
+            combTaps_[t * dsp::COMB_BANK_LANES + i] = c.buffer[t - first];
+    }
+
+    dsp::kernels().combBank(combTaps_, input, state, combFeedback_, combGain_, damping_,
+                            output, numFrames);
+
+    for (int i = 0; i < NUM_COMBS; i++) {
+        CombFilter& c = combs[i];
+        int first = std::min(numFrames, c.size - c.idx);
+        for (int t = 0; t < first; t++)
+            c.buffer[c.idx + t] = combTaps_[t * dsp::COMB_BANK_LANES + i];
+        for (int t = first; t < numFrames; t++)
+            c.buffer[t - first] = combTaps_[t * dsp::COMB_BANK_LANES + i];
+        c.idx += numFrames;
+        if (c.idx >= c.size) c.idx -= c.size;
+    }
+}
+
 void Reverb::reset() {
     for (int i = 0; i < NUM_COMBS; i++) {
         combL_[i].reset();
@@ -257,9 +584,12 @@ void Reverb::reset() {
         outputApL_[i].reset();
         outputApR_[i].reset();
     }
+    std::fill(combStateL_, combStateL_ + dsp::COMB_BANK_LANES, 0.0f);
+    std::fill(combStateR_, combStateR_ + dsp::COMB_BANK_LANES, 0.0f);
     preDelay_.reset();
     lateDelayL_.reset();
     lateDelayR_.reset();
     inputHPF_.reset();
     inputLPF_.reset();
+    resetFDN();
 }
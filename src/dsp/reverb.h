@@ -1,10 +1,21 @@
 #pragma once
-#include <vector>
 #include <atomic>
+#include <cstdint>
 #include "biquad.h"
+#include "cpu_dispatch.h"
+#include "scratch_arena.h"
+
+// Freeverb is the original comb/allpass engine; the FDN variants run 8 or 16
+// delay lines through a Hadamard feedback matrix.
+enum class ReverbAlgorithm {
+    Freeverb = 0,
+    FDN8 = 1,
+    FDN16 = 2
+};
 
 struct ReverbParams {
     std::atomic<bool>  enabled{true};
+    std::atomic<int>   algorithm{0};
     std::atomic<float> decayTime{0.9f};
     std::atomic<float> hiRatio{0.7f};
     std::atomic<float> diffusion{0.9f};
@@ -16,13 +27,28 @@ struct ReverbParams {
     std::atomic<float> balance{20.0f};
 };
 
+struct ReverbSettings {
+    bool  enabled = true;
+    int   algorithm = 0;
+    float decayTime = 0.9f;
+    float hiRatio = 0.7f;
+    float diffusion = 0.9f;
+    float initialDelay = 26.0f;
+    float density = 3.0f;
+    float lpfFreq = 11000.0f;
+    float hpfFreq = 90.0f;
+    float reverbDelay = 17.0f;
+    float balance = 20.0f;
+    uint32_t version = 0;
+};
+
 class Reverb {
 public:
     Reverb();
 
-    void init(float sampleRate);
-    void updateParams(const ReverbParams& params);
-    void process(float* buffer, int numFrames, int numChannels);
+    void prepare(float sampleRate, int maxBlockFrames, int numChannels, ScratchArena& arena);
+    void updateParams(const ReverbSettings& settings);
+    void process(float* const* channels, int numFrames, int numChannels);
     void reset();
 
 private:
@@ -31,40 +57,52 @@ private:
     static constexpr int NUM_OUTPUT_AP = 2;
     static constexpr int STEREO_SPREAD = 37;
     static constexpr float INPUT_GAIN = 0.012f;
+    static constexpr int MAX_FDN_LINES = 16;
+    static constexpr float FDN_INPUT_GAIN = 0.02f;
+    // Frames the comb bank runs per kernel call
+    static constexpr int COMB_TILE = 64;
 
+    // Delay line of one comb; the damping state lives with the bank
     struct CombFilter {
-        std::vector<float> buffer;
+        float* buffer = nullptr;
         int size = 0;
         int idx = 0;
-        float filterState = 0.0f;
 
-        void init(int sz);
-        float process(float input, float feedback, float damping);
+        void init(int sz, ScratchArena& arena);
         void reset();
     };
 
     struct AllpassFilter {
-        std::vector<float> buffer;
+        float* buffer = nullptr;
         int size = 0;
         int idx = 0;
 
-        void init(int sz);
+        void init(int sz, ScratchArena& arena);
         float process(float input, float feedback);
         void reset();
     };
 
     struct DelayLine {
-        std::vector<float> buffer;
+        float* buffer = nullptr;
         int size = 0;
         int writeIdx = 0;
         int readIdx = 0;
 
-        void init(int maxSamples);
+        void init(int maxSamples, ScratchArena& arena);
         void setDelay(int samples);
         float process(float input);
         void reset();
     };
 
+    // Mono blocks pass the one channel as both left and right
+    void processFreeverb(float* left, float* right, int numFrames);
+    void runCombBank(CombFilter* combs, float* state, const float* input, float* output, int numFrames);
+    template<int N>
+    void processFDN(float* left, float* right, int numFrames);
+    void updateFDNDecay(float decayTime, float hiRatio);
+    void updateFDNTaps(float density);
+    void resetFDN();
+
     CombFilter combL_[NUM_COMBS];
     CombFilter combR_[NUM_COMBS];
 
@@ -79,17 +117,44 @@ private:
     Biquad inputHPF_;
     Biquad inputLPF_;
 
-    float combFeedback_[NUM_COMBS] = {};
-    float combGain_[NUM_COMBS] = {};
+    // Comb bank, one lane per comb and zero past NUM_COMBS. Each tile of
+    // frames is gathered from the lines into combTaps_, run through the
+    // dispatched kernel and scattered back, which is exact as long as the
+    // tile is shorter than every line.
+    alignas(64) float combFeedback_[dsp::COMB_BANK_LANES] = {};
+    alignas(64) float combGain_[dsp::COMB_BANK_LANES] = {};
+    alignas(64) float combStateL_[dsp::COMB_BANK_LANES] = {};
+    alignas(64) float combStateR_[dsp::COMB_BANK_LANES] = {};
+    alignas(64) float combTaps_[COMB_TILE * dsp::COMB_BANK_LANES] = {};
+    float combIn_[2][COMB_TILE] = {};
+    float combOut_[2][COMB_TILE] = {};
+    int combTile_ = COMB_TILE;
     float combNorm_ = 1.0f;
     float damping_ = 0.3f;
     float diffusionFb_ = 0.5f;
     float wet_ = 0.2f;
     float dry_ = 0.8f;
 
+    // FDN state, structure-of-arrays so decay, damping and mixing run on
+    // whole registers. All lines share one power-of-two ring with the lines
+    // interleaved per frame, so the write side is a single contiguous store
+    // and one position counter. Line i feeds the left output when even,
+    // right when odd.
+    ReverbAlgorithm algorithm_ = ReverbAlgorithm::Freeverb;
+    int fdnLines_ = 8;
+    float* fdnData_ = nullptr;
+    int fdnMask_ = 0;
+    int fdnWritePos_ = 0;
+    int fdnDelay_[MAX_FDN_LINES] = {};
+    alignas(16) float fdnGain_[MAX_FDN_LINES] = {};
+    alignas(16) float fdnDamp_[MAX_FDN_LINES] = {};
+    alignas(16) float fdnState_[MAX_FDN_LINES] = {};
+    alignas(16) float fdnOutGain_[MAX_FDN_LINES] = {};
+
     float sampleRate_ = 48000.0f;
     bool initialized_ = false;
 
+    uint32_t lastVersion_ = ~0u;
     float lastDecayTime_ = -1.0f;
     float lastHiRatio_ = -1.0f;
     float lastDiffusion_ = -1.0f;
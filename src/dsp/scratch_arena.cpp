@@ -0,0 +1,53 @@
+#include "scratch_arena.h"
+#include <cstring>
+#include <algorithm>
+
+void ScratchArena::addBlock(size_t minBytes) {
+    Block block;
+    block.size = std::max(minBytes, MIN_BLOCK_SIZE);
+    block.memory.reset(new uint8_t[block.size + ALIGNMENT]);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block.memory.get());
+    block.base = block.memory.get() + ((ALIGNMENT - (addr % ALIGNMENT)) % ALIGNMENT);
+    blocks_.push_back(std::move(block));
+}
+
+void ScratchArena::reset() {
+    if (blocks_.size() > 1) {
+        size_t total = getCapacity();
+        blocks_.clear();
+        addBlock(total);
+    }
+    for (auto& block : blocks_) block.used = 0;
+}
+
+void* ScratchArena::allocateBytes(size_t bytes) {
+    bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    if (blocks_.empty() || blocks_.back().size - blocks_.back().used < bytes)
+        addBlock(bytes);
+
+    Block& block = blocks_.back();
+    void* ptr = block.base + block.used;
+    block.used += bytes;
+    std::memset(ptr, 0, bytes);
+    return ptr;
+}
+
+float** ScratchArena::allocateChannels(int numChannels, size_t numFrames) {
+    float** channels = allocate<float*>((size_t)numChannels);
+    for (int ch = 0; ch < numChannels; ch++)
+        channels[ch] = allocate<float>(numFrames);
+    return channels;
+}
+
+size_t ScratchArena::getBytesUsed() const {
+    size_t total = 0;
+    for (const auto& block : blocks_) total += block.used;
+    return total;
+}
+
+size_t ScratchArena::getCapacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks_) total += block.size;
+    return total;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator backing every buffer the DSP stages need at run time. It is
+// only allocated from inside prepare(); process() never touches the heap.
+class ScratchArena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    // Rewinds the arena. If the last layout spilled into more than one block,
+    // the blocks are merged so the next layout fits in a single allocation.
+    void reset();
+
+    template<typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "arena memory is released without running destructors");
+        void* mem = allocateBytes(count * sizeof(T));
+        T* items = static_cast<T*>(mem);
+        for (size_t i = 0; i < count; i++) new (&items[i]) T();
+        return items;
+    }
+
+    // A planar block: numChannels arrays of numFrames floats, each starting
+    // on its own ALIGNMENT boundary.
+    float** allocateChannels(int numChannels, size_t numFrames);
+
+    int getNumBlocks() const { return (int)blocks_.size(); }
+    size_t getBytesUsed() const;
+    size_t getCapacity() const;
+
+private:
+    static constexpr size_t MIN_BLOCK_SIZE = 256 * 1024;
+
+    struct Block {
+        std::unique_ptr<uint8_t[]> memory;
+        uint8_t* base = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    void* allocateBytes(size_t bytes);
+    void addBlock(size_t minBytes);
+
+    std::vector<Block> blocks_;
+};
@@ -1,21 +1,70 @@
 #include "spectral_analyzer.h"
+#include "float_guard.h"
+#include <chrono>
 #include <cstring>
 #include <cmath>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+// Below the audio and GUI threads, but not idle-only: the energies go stale
+// if the thread is starved for long
+void lowerCurrentThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    // Normal Linux threads share one static priority; niceness is what ranks
+    // them, and nice() only changes the calling thread's
+    int niceness = nice(5);
+    (void)niceness;
+#else
+    int policy;
+    sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+        param.sched_priority = sched_get_priority_min(policy);
+        pthread_setschedparam(pthread_self(), policy, &param);
+    }
+#endif
+}
+
+} // namespace
+
 SpectralAnalyzer::SpectralAnalyzer() {
     init(48000.0f);
 }
 
+SpectralAnalyzer::~SpectralAnalyzer() {
+    stopThread();
+}
+
 void SpectralAnalyzer::init(float sampleRate, int fftSize) {
+    stopThread();
+
     sampleRate_ = sampleRate;
     fftSize_ = fftSize;
 
-    fftBuffer_.resize(fftSize, 0.0f);
-    magnitudes_.resize(fftSize / 2, 0.0f);
+    fft_ = RealFFT::get(fftSize);
+    fftBuffer_.assign(fftSize, 0.0f);
+    frame_.assign(fftSize, 0.0f);
+    spectrum_.assign(fftSize + 2, 0.0f);
+    magnitudes_.assign(fftSize / 2, 0.0f);
     window_.resize(fftSize);
 
     for (int i = 0; i < fftSize; i++) {
@@ -33,49 +82,116 @@ void SpectralAnalyzer::init(float sampleRate, int fftSize) {
     bands_.push_back({12000.0f, 16000.0f, 0.0f, 1.0f});
     bands_.push_back({16000.0f, 20000.0f, 0.0f, 1.0f});
 
-    writePos_ = 0;
+    tap_.reset();
+    resetRequested_.store(false, std::memory_order_relaxed);
+    clearHistory();
 }
 
-void SpectralAnalyzer::process(const float* buffer, int numFrames, int numChannels) {
-    for (int i = 0; i < numFrames; i++) {
-        float sample = 0.0f;
-        for (int ch = 0; ch < numChannels; ch++) {
-            sample += buffer[i * numChannels + ch];
-        }
-        sample /= numChannels;
+void SpectralAnalyzer::setBackground(bool enable) {
+    background_ = enable;
+    if (!background_)
+        stopThread();
+}
 
-        fftBuffer_[writePos_] = sample;
-        writePos_ = (writePos_ + 1) % fftSize_;
+void SpectralAnalyzer::start() {
+    if (!background_ || running_.load(std::memory_order_relaxed)) return;
+    stopThread();
+    startThread();
+}
 
-        if ((writePos_ % (fftSize_ / 4)) == 0) {
-            performFFT(fftBuffer_.data(), fftSize_);
-            updateBandEnergies();
+void SpectralAnalyzer::stop() {
+    running_.store(false, std::memory_order_release);
+}
+
+void SpectralAnalyzer::startThread() {
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&SpectralAnalyzer::analysisLoop, this);
+}
+
+void SpectralAnalyzer::stopThread() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void SpectralAnalyzer::analysisLoop() {
+    dsp::ScopedFlushDenormals noDenormals;
+    lowerCurrentThreadPriority();
+    while (running_.load(std::memory_order_acquire)) {
+        if (!drainTap())
+            std::this_thread::sleep_for(std::chrono::milliseconds(ANALYSIS_POLL_MS));
+    }
+}
+
+void SpectralAnalyzer::push(const float* const* channels, int numFrames, int numChannels) {
+    CircularBuffer<float>::Region region = tap_.reserveWrite((size_t)numFrames);
+    float scale = 1.0f / numChannels;
+    float* parts[2] = { region.first, region.second };
+    size_t counts[2] = { region.firstCount, region.secondCount };
+    size_t frame = 0;
+    for (int p = 0; p < 2; p++) {
+        float* dst = parts[p];
+        for (size_t i = 0; i < counts[p]; i++)
+            dst[i] = channels[0][frame + i];
+        for (int ch = 1; ch < numChannels; ch++) {
+            const float* src = channels[ch] + frame;
+            for (size_t i = 0; i < counts[p]; i++)
+                dst[i] += src[i];
         }
+        for (size_t i = 0; i < counts[p]; i++)
+            dst[i] *= scale;
+        frame += counts[p];
     }
+    tap_.commitWrite(region.size());
+
+    if (!thread_.joinable())
+        drainTap();
 }
 
-void SpectralAnalyzer::performFFT(const float* input, int size) {
-    int halfSize = size / 2;
+// Consumer side of the tap: the analysis thread, or push() itself inline
+bool SpectralAnalyzer::drainTap() {
+    if (resetRequested_.exchange(false, std::memory_order_acquire)) {
+        tap_.discard(tap_.capacity());
+        clearHistory();
+    }
 
-    for (int k = 0; k < halfSize; k += 16) {
-        float real = 0.0f;
-        float imag = 0.0f;
+    CircularBuffer<float>::Region region = tap_.peekRead(tap_.capacity());
+    if (region.size() == 0) return false;
+    consume(region.first, region.firstCount);
+    consume(region.second, region.secondCount);
+    tap_.consumeRead(region.size());
+    return true;
+}
 
-        float w = 2.0f * M_PI * k / size;
+void SpectralAnalyzer::consume(const float* samples, size_t count) {
+    int hop = fftSize_ / 4;
+    for (size_t i = 0; i < count; i++) {
+        fftBuffer_[writePos_] = samples[i];
+        writePos_ = (writePos_ + 1) % fftSize_;
 
-        for (int n = 0; n < size; n += 8) {
-            float windowed = input[n] * window_[n];
-            real += windowed * std::cos(w * n);
-            imag += windowed * std::sin(w * n);
+        if ((writePos_ % hop) == 0) {
+            performFFT();
+            updateBandEnergies();
+            publishEnergies();
         }
+    }
+}
 
-        magnitudes_[k] = std::sqrt(real * real + imag * imag) / (size / 8);
+void SpectralAnalyzer::performFFT() {
+    // fftBuffer_ is circular; writePos_ is the oldest sample
+    for (int i = 0; i < fftSize_; i++) {
+        int idx = (writePos_ + i) & (fftSize_ - 1);
+        frame_[i] = fftBuffer_[idx] * window_[i];
+    }
 
-        if (k + 16 < halfSize) {
-            for (int j = 1; j < 16; j++) {
-                magnitudes_[k + j] = magnitudes_[k];
-            }
-        }
+    fft_->forward(frame_.data(), spectrum_.data());
+
+    float norm = 1.0f / fftSize_;
+    int halfSize = fftSize_ / 2;
+    for (int k = 0; k < halfSize; k++) {
+        float re = spectrum_[2 * k];
+        float im = spectrum_[2 * k + 1];
+        magnitudes_[k] = std::sqrt(re * re + im * im) * norm;
     }
 }
 
@@ -109,20 +225,33 @@ void SpectralAnalyzer::updateBandEnergies() {
     avgEnergy_ = totalEnergy / bands_.size();
 }
 
-float SpectralAnalyzer::getBandEnergy(float lowFreq, float highFreq) const {
-    for (const auto& band : bands_) {
-        if (band.lowFreq <= lowFreq && band.highFreq >= highFreq) {
-            return band.energy;
+void SpectralAnalyzer::publishEnergies() {
+    Energies& out = energies_.getWriteBuffer();
+    for (int b = 0; b < MAX_BANDS; b++)
+        out.band[b] = b < (int)bands_.size() ? bands_[b].energy : 0.0f;
+    out.average = avgEnergy_;
+    energies_.publish();
+}
+
+int SpectralAnalyzer::findBand(float lowFreq, float highFreq) const {
+    for (size_t b = 0; b < bands_.size(); b++) {
+        if (bands_[b].lowFreq <= lowFreq && bands_[b].highFreq >= highFreq) {
+            return (int)b;
         }
     }
-    return 0.0f;
+    return -1;
 }
 
-float SpectralAnalyzer::getAverageEnergy() const {
-    return avgEnergy_;
+void SpectralAnalyzer::reset() {
+    if (thread_.joinable()) {
+        resetRequested_.store(true, std::memory_order_release);
+        return;
+    }
+    tap_.discard(tap_.capacity());
+    clearHistory();
 }
 
-void SpectralAnalyzer::reset() {
+void SpectralAnalyzer::clearHistory() {
     std::fill(fftBuffer_.begin(), fftBuffer_.end(), 0.0f);
     std::fill(magnitudes_.begin(), magnitudes_.end(), 0.0f);
     for (auto& band : bands_) {
@@ -130,4 +259,5 @@ void SpectralAnalyzer::reset() {
     }
     avgEnergy_ = 0.0f;
     writePos_ = 0;
+    publishEnergies();
 }
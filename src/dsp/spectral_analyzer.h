@@ -1,21 +1,67 @@
 #pragma once
+#include <atomic>
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <memory>
+#include <thread>
+#include "fft.h"
+#include "common/circular_buffer.h"
+#include "common/triple_buffer.h"
 
+// Band energies of the mono downmix, from a Hann-windowed FFT every quarter
+// frame. The audio thread only pushes the downmix into an SPSC tap; in
+// background mode a separate below-normal-priority thread drains it, runs the
+// FFTs and publishes the energies, so an FFT never lands inside an audio
+// callback.
 class SpectralAnalyzer {
 public:
+    static constexpr int MAX_BANDS = 9;
+
+    struct Energies {
+        float band[MAX_BANDS] = {};
+        float average = 0.0f;
+    };
+
     SpectralAnalyzer();
+    ~SpectralAnalyzer();
 
+    SpectralAnalyzer(const SpectralAnalyzer&) = delete;
+    SpectralAnalyzer& operator=(const SpectralAnalyzer&) = delete;
+
+    // Allocates and stops the analysis thread; start() brings it back.
     void init(float sampleRate, int fftSize = 4096);
-    void process(const float* buffer, int numFrames, int numChannels);
 
-    float getBandEnergy(float lowFreq, float highFreq) const;
-    float getAverageEnergy() const;
+    // Background mode is the default. With it off, push() analyses inline
+    // on the calling thread, so offline renders do not depend on how the
+    // analysis thread was scheduled. Not while push() may run.
+    void setBackground(bool enable);
+
+    // Audio thread, between push() calls: start() brings up the analysis
+    // thread in background mode, waiting for one that stop() let go if it is
+    // still winding down. stop() only tells the thread to finish its current
+    // pass and exit, so it never blocks.
+    void start();
+    void stop();
+
+    // Audio thread. Samples that do not fit in the tap are dropped.
+    void push(const float* const* channels, int numFrames, int numChannels);
 
+    // Audio thread: the most recently published energies
+    const Energies& readEnergies() { return energies_.read(); }
+
+    // Index into Energies::band of the band covering [lowFreq, highFreq],
+    // or -1 if there is none
+    int findBand(float lowFreq, float highFreq) const;
+
+    // Audio thread: the analysis thread drops its history on its next pass
     void reset();
 
 private:
+    // About 0.7 s at 48 kHz, far more than the thread ever lags
+    static constexpr size_t TAP_CAPACITY = 1 << 15;
+    static constexpr int ANALYSIS_POLL_MS = 5;
+
     struct FrequencyBand {
         float lowFreq;
         float highFreq;
@@ -23,10 +69,21 @@ private:
         float targetEnergy;
     };
 
-    void performFFT(const float* input, int size);
+    void startThread();
+    void stopThread();
+    void analysisLoop();
+    bool drainTap();
+    void consume(const float* samples, size_t count);
+    void clearHistory();
+
+    void performFFT();
     void updateBandEnergies();
+    void publishEnergies();
 
+    std::shared_ptr<const RealFFT> fft_;
     std::vector<float> fftBuffer_;
+    std::vector<float> frame_;
+    std::vector<float> spectrum_;
     std::vector<float> magnitudes_;
     std::vector<float> window_;
     std::vector<FrequencyBand> bands_;
@@ -35,4 +92,12 @@ private:
     int fftSize_ = 4096;
     int writePos_ = 0;
     float avgEnergy_ = 0.0f;
+
+    CircularBuffer<float> tap_{TAP_CAPACITY};
+    TripleBuffer<Energies> energies_;
+
+    bool background_ = true;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> resetRequested_{false};
 };
@@ -0,0 +1,101 @@
+#include "stage_profiler.h"
+
+const char* StageProfiler::getStageName(int stage) {
+    switch (stage) {
+        case EQ:          return "EQ";
+        case Tone:        return "Tone";
+        case Crossover:   return "Crossover";
+        case BandLimiter: return "Band Limiter";
+        case Multiband:   return "Multiband";
+        case Compressor:  return "Compressor";
+        case Reverb:      return "Reverb";
+        case SoftClip:    return "Soft Clip";
+        default:          return "?";
+    }
+}
+
+int StageProfiler::bucketIndex(uint64_t ns) {
+    if (ns < 4) return (int)ns;
+    int octave = 63;
+#if defined(__GNUC__) || defined(__clang__)
+    octave -= __builtin_clzll(ns);
+#else
+    while (!(ns >> octave)) octave--;
+#endif
+    int sub = (int)(ns >> (octave - 2)) & 3;
+    int index = octave * 4 + sub - 4;
+    return index < NUM_BUCKETS ? index : NUM_BUCKETS - 1;
+}
+
+uint64_t StageProfiler::bucketUpperBound(int index) {
+    if (index < 4) return (uint64_t)index;
+    int octave = (index + 4) / 4;
+    int sub = (index + 4) % 4;
+    return ((uint64_t)(5 + sub) << (octave - 2)) - 1;
+}
+
+void StageProfiler::beginBlock(int numFrames, float sampleRate) {
+    if (resetRequested_.load(std::memory_order_relaxed)) {
+        clear();
+        resetRequested_.store(false, std::memory_order_relaxed);
+    }
+    blockPeriodNs_ = (sampleRate > 0.0f) ? (uint64_t)(numFrames * 1e9 / sampleRate) : 0;
+}
+
+void StageProfiler::record(int stage, uint64_t elapsedNs) {
+    // Single writer: plain load/store pairs instead of read-modify-write
+    StageData& d = stages_[stage];
+    d.count.store(d.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    d.sumNs.store(d.sumNs.load(std::memory_order_relaxed) + elapsedNs, std::memory_order_relaxed);
+    d.sumPeriodNs.store(d.sumPeriodNs.load(std::memory_order_relaxed) + blockPeriodNs_,
+                        std::memory_order_relaxed);
+    if (elapsedNs < d.minNs.load(std::memory_order_relaxed))
+        d.minNs.store(elapsedNs, std::memory_order_relaxed);
+    if (elapsedNs > d.maxNs.load(std::memory_order_relaxed))
+        d.maxNs.store(elapsedNs, std::memory_order_relaxed);
+
+    std::atomic<uint32_t>& bucket = d.buckets[bucketIndex(elapsedNs)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+StageProfiler::Stats StageProfiler::getStats(int stage) const {
+    Stats s;
+    if (stage < 0 || stage >= NUM_STAGES) return s;
+
+    const StageData& d = stages_[stage];
+    s.count = d.count.load(std::memory_order_relaxed);
+    if (s.count == 0) return s;
+
+    uint64_t sumNs = d.sumNs.load(std::memory_order_relaxed);
+    uint64_t sumPeriodNs = d.sumPeriodNs.load(std::memory_order_relaxed);
+    s.minUs = d.minNs.load(std::memory_order_relaxed) * 1e-3f;
+    s.maxUs = d.maxNs.load(std::memory_order_relaxed) * 1e-3f;
+    s.avgUs = (float)(sumNs * 1e-3 / s.count);
+    s.loadPercent = sumPeriodNs ? (float)(100.0 * sumNs / sumPeriodNs) : 0.0f;
+
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+        total += d.buckets[i].load(std::memory_order_relaxed);
+    uint64_t target = total - total / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += d.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target && seen > 0) {
+            s.p99Us = bucketUpperBound(i) * 1e-3f;
+            break;
+        }
+    }
+    if (s.p99Us > s.maxUs) s.p99Us = s.maxUs;
+    return s;
+}
+
+void StageProfiler::clear() {
+    for (StageData& d : stages_) {
+        d.count.store(0, std::memory_order_relaxed);
+        d.sumNs.store(0, std::memory_order_relaxed);
+        d.sumPeriodNs.store(0, std::memory_order_relaxed);
+        d.minNs.store(UINT64_MAX, std::memory_order_relaxed);
+        d.maxNs.store(0, std::memory_order_relaxed);
+        for (auto& b : d.buckets) b.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Build with -DDSP_PROFILING=0 to compile every timing point out of the chain.
+#ifndef DSP_PROFILING
+#define DSP_PROFILING 1
+#endif
+
+// Per-stage timing of DSPChain::process. The audio thread is the only writer;
+// any thread may read the statistics. Durations go into log-spaced
+// histograms (four buckets per octave of nanoseconds) from which p99 is read.
+class StageProfiler {
+public:
+    enum Stage {
+        EQ,
+        Tone,
+        Crossover,
+        BandLimiter,
+        Multiband,
+        Compressor,
+        Reverb,
+        SoftClip,
+        NUM_STAGES
+    };
+
+    struct Stats {
+        uint64_t count = 0;
+        float minUs = 0.0f;
+        float avgUs = 0.0f;
+        float p99Us = 0.0f;
+        float maxUs = 0.0f;
+        // Share of the audio block period spent in the stage, on average
+        float loadPercent = 0.0f;
+    };
+
+    static const char* getStageName(int stage);
+    static uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Audio thread
+    void beginBlock(int numFrames, float sampleRate);
+    void record(int stage, uint64_t elapsedNs);
+
+    // Any thread. reset() is applied by the audio thread at its next block.
+    Stats getStats(int stage) const;
+    void reset() { resetRequested_.store(true, std::memory_order_relaxed); }
+
+    class Scope {
+    public:
+        Scope(StageProfiler& profiler, int stage)
+            : profiler_(profiler), stage_(stage), start_(now()) {}
+        ~Scope() { profiler_.record(stage_, now() - start_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StageProfiler& profiler_;
+        int stage_;
+        uint64_t start_;
+    };
+
+private:
+    static constexpr int NUM_BUCKETS = 128;
+
+    static int bucketIndex(uint64_t ns);
+    static uint64_t bucketUpperBound(int index);
+
+    struct StageData {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint64_t> sumPeriodNs{0};
+        std::atomic<uint64_t> minNs{UINT64_MAX};
+        std::atomic<uint64_t> maxNs{0};
+        std::atomic<uint32_t> buckets[NUM_BUCKETS] = {};
+    };
+
+    void clear();
+
+    StageData stages_[NUM_STAGES];
+    uint64_t blockPeriodNs_ = 0;
+    std::atomic<bool> resetRequested_{false};
+};
+
+#if DSP_PROFILING
+#define DSP_PROFILE_CONCAT_(a, b) a##b
+#define DSP_PROFILE_CONCAT(a, b) DSP_PROFILE_CONCAT_(a, b)
+#define DSP_PROFILE_BLOCK(profiler, frames, rate) (profiler).beginBlock(frames, rate)
+#define DSP_PROFILE_SCOPE(profiler, stage) \
+    StageProfiler::Scope DSP_PROFILE_CONCAT(profileScope_, __LINE__)(profiler, stage)
+#else
+#define DSP_PROFILE_BLOCK(profiler, frames, rate) ((void)0)
+#define DSP_PROFILE_SCOPE(profiler, stage) ((void)0)
+#endif
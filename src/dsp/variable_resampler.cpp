@@ -0,0 +1,131 @@
+#include "variable_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+// Passband edge as a fraction of the sample rate (21.6 kHz at 48 kHz)
+constexpr double CUTOFF = 0.45;
+constexpr double KAISER_BETA = 8.0;
+
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+} // namespace
+
+void VariableResampler::prepare(int numChannels, int maxOutputFrames, double maxDeviation) {
+    numChannels_ = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    maxOutputFrames_ = maxOutputFrames;
+    maxDeviation_ = maxDeviation;
+
+    if (table_.empty()) buildTable();
+    coeffs_.assign(TAPS, 0.0f);
+
+    int maxInputFrames = (int)std::ceil(maxOutputFrames * (1.0 + maxDeviation)) + 2;
+    history_.assign((size_t)(TAPS + 2 + maxInputFrames) * numChannels_, 0.0f);
+    setRatio(1.0);
+    reset();
+}
+
+void VariableResampler::buildTable() {
+    table_.assign((size_t)(PHASES + 1) * TAPS, 0.0f);
+    double i0Beta = besselI0(KAISER_BETA);
+
+    for (int p = 0; p <= PHASES; p++) {
+        double frac = (double)p / PHASES;
+        float* row = &table_[(size_t)p * TAPS];
+        double sum = 0.0;
+        for (int k = 0; k < TAPS; k++) {
+            // Distance from tap k to the output position, in input frames
+            double d = frac + HALF_TAPS - 1 - k;
+            double x = 2.0 * CUTOFF * d;
+            double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(PI * x) / (PI * x);
+            double w = d / HALF_TAPS;
+            double window = (std::fabs(w) >= 1.0) ? 0.0
+                          : besselI0(KAISER_BETA * std::sqrt(1.0 - w * w)) / i0Beta;
+            double h = 2.0 * CUTOFF * sinc * window;
+            row[k] = (float)h;
+            sum += h;
+        }
+        // Unity gain at DC for every phase, or the ratio wobble becomes audible
+        for (int k = 0; k < TAPS; k++) row[k] = (float)(row[k] / sum);
+    }
+}
+
+void VariableResampler::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    // HALF_TAPS - 1 frames of silence ahead of the first real input frame,
+    // which is where the first output is centred
+    bufferedFrames_ = HALF_TAPS - 1;
+    position_ = (uint64_t)(HALF_TAPS - 1) << FRAC_BITS;
+}
+
+void VariableResampler::setRatio(double ratio) {
+    ratio_ = std::max(1.0 - maxDeviation_, std::min(ratio, 1.0 + maxDeviation_));
+    step_ = (uint64_t)std::llround(ratio_ * (double)((uint64_t)1 << FRAC_BITS));
+}
+
+int VariableResampler::getInputFramesNeeded(int outputFrames) const {
+    if (outputFrames <= 0) return 0;
+    uint64_t last = position_ + (uint64_t)(outputFrames - 1) * step_;
+    int lastNeeded = (int)(last >> FRAC_BITS) + HALF_TAPS;
+    return std::max(0, lastNeeded + 1 - bufferedFrames_);
+}
+
+void VariableResampler::process(int inputFrames, float* out, int outputFrames) {
+    bufferedFrames_ += inputFrames;
+
+    constexpr int PHASE_SHIFT = FRAC_BITS - 8;  // log2(PHASES) == 8
+    constexpr uint64_t PHASE_FRAC_MASK = ((uint64_t)1 << PHASE_SHIFT) - 1;
+    constexpr float PHASE_FRAC_SCALE = 1.0f / (float)((uint64_t)1 << PHASE_SHIFT);
+    static_assert(PHASES == 256, "PHASE_SHIFT assumes 256 phases");
+
+    const float* x = history_.data();
+    float* c = coeffs_.data();
+    int nCh = numChannels_;
+
+    for (int n = 0; n < outputFrames; n++) {
+        int index = (int)(position_ >> FRAC_BITS);
+        uint32_t frac = (uint32_t)position_;
+        int phase = (int)(frac >> PHASE_SHIFT);
+        float mix = (float)(frac & PHASE_FRAC_MASK) * PHASE_FRAC_SCALE;
+
+        const float* a = &table_[(size_t)phase * TAPS];
+        const float* b = a + TAPS;
+        for (int k = 0; k < TAPS; k++)
+            c[k] = a[k] + mix * (b[k] - a[k]);
+
+        const float* src = x + (size_t)(index - HALF_TAPS + 1) * nCh;
+        if (nCh == 2) {
+            float l = 0.0f, r = 0.0f;
+            for (int k = 0; k < TAPS; k++) {
+                l += c[k] * src[2 * k];
+                r += c[k] * src[2 * k + 1];
+            }
+            out[2 * n] = l;
+            out[2 * n + 1] = r;
+        } else {
+            float sum = 0.0f;
+            for (int k = 0; k < TAPS; k++)
+                sum += c[k] * src[k];
+            out[n] = sum;
+        }
+        position_ += step_;
+    }
+
+    // Keep only what the next output still reaches back to
+    int drop = std::min((int)(position_ >> FRAC_BITS) - HALF_TAPS + 1, bufferedFrames_);
+    if (drop > 0) {
+        std::memmove(history_.data(), history_.data() + (size_t)drop * nCh,
+                     (size_t)(bufferedFrames_ - drop) * nCh * sizeof(float));
+        bufferedFrames_ -= drop;
+        position_ -= (uint64_t)drop << FRAC_BITS;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Windowed-sinc polyphase resampler whose ratio may change every block, used
+// to absorb clock drift between two audio devices. Coefficients for
+// fractional positions between the tabulated phases are linearly
+// interpolated. The read position is 32.32 fixed point, so the number of input
+// frames a block needs is exact and does not depend on rounding history.
+class VariableResampler {
+public:
+    static constexpr int TAPS = 64;
+    static constexpr int HALF_TAPS = TAPS / 2;
+    static constexpr int PHASES = 256;
+    static constexpr int MAX_CHANNELS = 2;
+
+    // Allocates for blocks of up to maxOutputFrames with ratios within
+    // 1 +/- maxDeviation. Not real-time safe.
+    void prepare(int numChannels, int maxOutputFrames, double maxDeviation);
+    void reset();
+
+    // Input frames consumed per output frame; clamped to the prepared range
+    void setRatio(double ratio);
+    double getRatio() const { return ratio_; }
+
+    // Audio thread: write exactly getInputFramesNeeded(outputFrames) new
+    // frames to getInputBuffer(), then call process() with the same count.
+    int getInputFramesNeeded(int outputFrames) const;
+    float* getInputBuffer() { return history_.data() + (size_t)bufferedFrames_ * numChannels_; }
+    void process(int inputFrames, float* out, int outputFrames);
+
+    // Group delay in input frames
+    static constexpr int getLatencyFrames() { return HALF_TAPS; }
+
+private:
+    static constexpr int FRAC_BITS = 32;
+
+    void buildTable();
+
+    int numChannels_ = 2;
+    int maxOutputFrames_ = 0;
+    double maxDeviation_ = 0.0;
+    double ratio_ = 1.0;
+    uint64_t step_ = (uint64_t)1 << FRAC_BITS;
+
+    // (PHASES + 1) rows of TAPS; the extra row lets phase p+1 be read for p = PHASES-1
+    std::vector<float> table_;
+    std::vector<float> coeffs_;
+
+    std::vector<float> history_;
+    int bufferedFrames_ = 0;
+    uint64_t position_ = 0;   // next output, relative to history_[0], 32.32
+};
@@ -350,6 +350,12 @@ void CompressorPanel::render(CompressorParams& params, ToneParams& tone, ReverbP
     }
 
     if (reverbOn) {
+        const char* algorithmLabels[] = {"Freeverb", "FDN 8", "FDN 16"};
+        int algorithm = reverb.algorithm.load(std::memory_order_relaxed);
+        ImGui::Text("Engine");
+        if (ImGui::Combo("##rev_engine", &algorithm, algorithmLabels, 3)) {
+            reverb.algorithm.store(algorithm, std::memory_order_relaxed);
+        }
         ImGui::Text("Rev Time");
         if (ImGui::SliderFloat("##rev_time", &reverbDecayTime_, 0.1f, 10.0f, "%.1f s",
                                 ImGuiSliderFlags_Logarithmic)) {
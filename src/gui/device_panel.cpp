@@ -120,6 +120,21 @@ void DevicePanel::render() {
     }
     ImGui::PopItemWidth();
 
+    ImGui::SameLine(0, 15);
+    bool pullMode = params_->pullMode.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Pull mode", &pullMode))
+        params_->pullMode.store(pullMode, std::memory_order_relaxed);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Process in the output callback with a fixed FIFO target (restart to apply)");
+    if (pullMode) {
+        ImGui::SameLine();
+        ImGui::PushItemWidth(120);
+        float targetMs = params_->targetLatencyMs.load(std::memory_order_relaxed);
+        if (ImGui::SliderFloat("##targetlatency", &targetMs, 2.0f, 200.0f, "%.0f ms"))
+            params_->targetLatencyMs.store(targetMs, std::memory_order_relaxed);
+        ImGui::PopItemWidth();
+    }
+
     bool isRunning = engine_ && engine_->isRunning();
     if (isRunning) {
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
@@ -33,12 +33,12 @@ void EQPanel::initFromParams(EQParams& params) {
     freqLabels_.resize(n);
     for (int i = 0; i < n; i++) {
         bandGains_[i] = params.bands[i].gainDb.load(std::memory_order_relaxed);
-        freqLabels_[i] = formatFreq(params.bands[i].freq);
+        freqLabels_[i] = formatFreq(params.bands[i].freq.load(std::memory_order_relaxed));
     }
     initialized_ = true;
 }
 
-void EQPanel::render(EQParams& params) {
+void EQPanel::render(EQParams& params, int latencySamples) {
     if (!initialized_ || (int)bandGains_.size() != params.numBands()) {
         initFromParams(params);
     }
@@ -75,11 +75,22 @@ void EQPanel::render(EQParams& params) {
         }
     }
 
+    ImGui::SameLine();
+    bool linearPhase = params.linearPhase.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Linear Phase##eq", &linearPhase)) {
+        params.linearPhase.store(linearPhase, std::memory_order_relaxed);
+    }
+
     // Preamp display
     ImGui::SameLine();
     float preamp = params.preamp.load(std::memory_order_relaxed);
     ImGui::TextDisabled("Pre: %.1f dB", preamp);
 
+    if (latencySamples > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("+%d smp", latencySamples);
+    }
+
     if (nBands == 0) {
         ImGui::Spacing();
         ImGui::Text("No bands loaded. Check config.json");
@@ -106,15 +117,38 @@ void EQPanel::render(EQParams& params) {
             params.bands[i].gainDb.store(bandGains_[i], std::memory_order_relaxed);
         }
 
+        BandParam& band = params.bands[i];
+
         // Tooltip with full info on hover
         if (ImGui::IsItemHovered()) {
-            ImGui::SetTooltip("%s %.0fHz Q:%.1f\n%.1f dB",
-                filterTypeName(params.bands[i].type),
-                params.bands[i].freq,
-                params.bands[i].q,
+            ImGui::SetTooltip("%s %.0fHz Q:%.1f\n%.1f dB\nRight-click to edit",
+                filterTypeName(band.type.load(std::memory_order_relaxed)),
+                band.freq.load(std::memory_order_relaxed),
+                band.q.load(std::memory_order_relaxed),
                 bandGains_[i]);
         }
 
+        // Type, frequency and Q, applied live like the gain
+        if (ImGui::BeginPopupContextItem(id)) {
+            const char* typeLabels[] = {"High Shelf","Low Shelf","Peaking","Band Pass","High Pass","Low Pass"};
+            int typeIndex = band.type.load(std::memory_order_relaxed) - 1;
+            if (typeIndex < 0 || typeIndex >= 6) typeIndex = 2;
+            if (ImGui::Combo("Type", &typeIndex, typeLabels, 6)) {
+                band.type.store(typeIndex + 1, std::memory_order_relaxed);
+            }
+            float freq = band.freq.load(std::memory_order_relaxed);
+            if (ImGui::SliderFloat("Freq", &freq, 20.0f, 20000.0f, "%.0f Hz",
+                                    ImGuiSliderFlags_Logarithmic)) {
+                band.freq.store(freq, std::memory_order_relaxed);
+                freqLabels_[i] = formatFreq(freq);
+            }
+            float q = band.q.load(std::memory_order_relaxed);
+            if (ImGui::SliderFloat("Q", &q, 0.1f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic)) {
+                band.q.store(q, std::memory_order_relaxed);
+            }
+            ImGui::EndPopup();
+        }
+
         // Gain value label
         char valBuf[16];
         snprintf(valBuf, sizeof(valBuf), "%.0f", bandGains_[i]);
@@ -5,7 +5,7 @@
 
 class EQPanel {
 public:
-    void render(EQParams& params);
+    void render(EQParams& params, int latencySamples);
 
 private:
     std::vector<float> bandGains_;
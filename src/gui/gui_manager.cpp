@@ -12,7 +12,7 @@ GUIManager::GUIManager(SharedParams& params, AudioEngine& engine, AudioDeviceMan
 
 void GUIManager::init() {
     devicePanel_.init(deviceMgr_, engine_, params_);
-    multibandPanel_.init(params_, dsp_);
+    multibandPanel_.init(params_, engine_);
 
     char exePath[MAX_PATH] = {};
     GetModuleFileNameA(nullptr, exePath, MAX_PATH);
@@ -35,11 +35,12 @@ void GUIManager::saveConfig() {
 
     cfg.eq.name = params_.eq.configName;
     cfg.eq.preamp = params_.eq.preamp.load(std::memory_order_relaxed);
+    cfg.eq.linearPhase = params_.eq.linearPhase.load(std::memory_order_relaxed);
     for (int i = 0; i < params_.eq.numBands(); i++) {
         ConfigBand cb;
-        cb.type = params_.eq.bands[i].type;
-        cb.frequency = params_.eq.bands[i].freq;
-        cb.q = params_.eq.bands[i].q;
+        cb.type = params_.eq.bands[i].type.load(std::memory_order_relaxed);
+        cb.frequency = params_.eq.bands[i].freq.load(std::memory_order_relaxed);
+        cb.q = params_.eq.bands[i].q.load(std::memory_order_relaxed);
         cb.gain = params_.eq.bands[i].gainDb.load(std::memory_order_relaxed);
         cfg.eq.bands.push_back(cb);
     }
@@ -86,6 +87,7 @@ void GUIManager::saveConfig() {
     }
 
     cfg.reverb.enabled = params_.reverb.enabled.load(std::memory_order_relaxed);
+    cfg.reverb.algorithm = params_.reverb.algorithm.load(std::memory_order_relaxed);
     cfg.reverb.decayTime = compressorPanel_.getReverbDecayTime();
     cfg.reverb.hiRatio = compressorPanel_.getReverbHiRatio();
     cfg.reverb.diffusion = compressorPanel_.getReverbDiffusion();
@@ -105,11 +107,14 @@ void GUIManager::saveConfig() {
     cfg.multiband.subBassBoost = params_.multiband.subBassBoost.load(std::memory_order_relaxed);
     cfg.multiband.subBassLowFreq = params_.multiband.subBassLowFreq.load(std::memory_order_relaxed);
     cfg.multiband.subBassHighFreq = params_.multiband.subBassHighFreq.load(std::memory_order_relaxed);
+    cfg.multiband.multirate = params_.multiband.multirate.load(std::memory_order_relaxed);
 
     cfg.devices.captureFrom = devicePanel_.getSelectedInputName();
     cfg.devices.playTo = devicePanel_.getSelectedOutputName();
 
     cfg.audio.blockSize = params_.blockSize.load(std::memory_order_relaxed);
+    cfg.audio.pullMode = params_.pullMode.load(std::memory_order_relaxed);
+    cfg.audio.targetLatencyMs = params_.targetLatencyMs.load(std::memory_order_relaxed);
 
     if (config::saveConfig(configPath_, cfg)) {
         showSaveOk_ = true;
@@ -157,15 +162,17 @@ void GUIManager::render() {
 
     ImGui::Spacing();
 
-    float gr = engine_.getGainReduction();
+    float gr = engine_.getTelemetry().compressorGainReductionDb;
     compressorPanel_.render(params_.compressor, params_.tone, params_.reverb, params_.crossover,
                             params_.bandLimiter, gr);
 
     ImGui::SameLine();
-    eqPanel_.render(params_.eq);
+    eqPanel_.render(params_.eq, dsp_.getLatencySamples());
 
     ImGui::SameLine();
     meterPanel_.render(engine_);
 
     ImGui::End();
+
+    params_.publish();
 }
@@ -1,5 +1,6 @@
 #include "meter_panel.h"
 #include "imgui.h"
+#include "dsp/cpu_dispatch.h"
 #include "dsp/dsp_common.h"
 #include <algorithm>
 #include <cmath>
@@ -16,11 +17,12 @@ void MeterPanel::render(AudioEngine& engine) {
 
     float fallSpeed = 0.15f;
 
-    float inL = engine.getInputLevelL();
-    float inR = engine.getInputLevelR();
-    float outL = engine.getOutputLevelL();
-    float outR = engine.getOutputLevelR();
-    float gr = engine.getGainReduction();
+    Telemetry meters = engine.getTelemetry();
+    float inL = meters.inputPeak[0];
+    float inR = meters.inputPeak[1];
+    float outL = meters.outputPeak[0];
+    float outR = meters.outputPeak[1];
+    float gr = meters.compressorGainReductionDb;
 
     displayInputL_ = smoothValue(displayInputL_, inL, fallSpeed);
     displayInputR_ = smoothValue(displayInputR_, inR, fallSpeed);
@@ -70,6 +72,38 @@ void MeterPanel::render(AudioEngine& engine) {
     ImGui::TextDisabled("DEBUG");
     ImGui::Text("Rate: %d Hz  Ch: %d", engine.getDebugSampleRate(), engine.getDebugChannels());
     ImGui::Text("Frames: %u", (unsigned)engine.getDebugFrameCount());
+    if (engine.isPullMode())
+        ImGui::Text("Latency: %.1f ms  Drift: %+.0f ppm", engine.getDebugLatencyMs(), engine.getDebugDriftPpm());
+    ImGui::Text("Underruns: %u  Overruns: %u", engine.getDebugUnderruns(), engine.getDebugOverruns());
+    if (meters.nonFiniteResets > 0)
+        ImGui::Text("NaN/Inf stage resets: %u", meters.nonFiniteResets);
+
+    // Switching takes effect from the next block; the stage timings below
+    // show the difference
+    dsp::Isa activeIsa = dsp::activeIsa();
+    if (ImGui::BeginCombo("Kernels", dsp::isaName(activeIsa))) {
+        for (dsp::Isa isa : { dsp::Isa::Scalar, dsp::Isa::SSE2, dsp::Isa::AVX2,
+                              dsp::Isa::AVX512, dsp::Isa::NEON }) {
+            if (!dsp::isaSupported(isa)) continue;
+            if (ImGui::Selectable(dsp::isaName(isa), isa == activeIsa))
+                dsp::setIsa(isa);
+        }
+        ImGui::EndCombo();
+    }
+
+#if DSP_PROFILING
+    ImGui::Spacing();
+    ImGui::TextDisabled("STAGE CPU (us: avg / p99 / max)");
+    for (int stage = 0; stage < StageProfiler::NUM_STAGES; stage++) {
+        StageProfiler::Stats st = engine.getDebugStageStats(stage);
+        if (st.count == 0) continue;
+        ImGui::Text("%-12s %6.1f %6.1f %6.1f  %4.1f%%", StageProfiler::getStageName(stage),
+                    st.avgUs, st.p99Us, st.maxUs, st.loadPercent);
+    }
+    if (ImGui::SmallButton("Reset##profiler")) {
+        engine.resetDebugStageStats();
+    }
+#endif
 
     ImGui::EndChild();
 }
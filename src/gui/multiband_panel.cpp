@@ -1,13 +1,13 @@
 #include "multiband_panel.h"
 #include "imgui.h"
 
-void MultibandPanel::init(SharedParams& params, DSPChain& dsp) {
+void MultibandPanel::init(SharedParams& params, const AudioEngine& engine) {
     params_ = &params;
-    dsp_ = &dsp;
+    engine_ = &engine;
 }
 
 void MultibandPanel::render() {
-    if (!params_ || !dsp_) return;
+    if (!params_ || !engine_) return;
 
     ImGui::BeginChild("MultibandProcessor", ImVec2(0, 220), true);
     ImGui::TextColored(ImVec4(0.3f, 0.8f, 1.0f, 1.0f), "MULTIBAND SPECTRAL PROCESSOR (250Hz-20kHz)");
@@ -102,27 +102,36 @@ void MultibandPanel::render() {
         params_->multiband.outputGain.store(outputGain, std::memory_order_relaxed);
     }
 
+    bool multirate = params_->multiband.multirate.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Multirate Low Bands", &multirate)) {
+        params_->multiband.multirate.store(multirate, std::memory_order_relaxed);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Processes the two lowest bands at a reduced sample rate (less CPU, about 2 ms more latency)");
+    }
+
     ImGui::Spacing();
     ImGui::Separator();
 
     // Display band energies
     ImGui::Text("Spectral Energy (Real-time FFT):");
-    auto& multiband = dsp_->getMultiband();
-    int numBands = multiband.getNumBands();
+    Telemetry meters = engine_->getTelemetry();
+    int numBands = meters.numBands;
 
     for (int i = 0; i < numBands; i++) {
-        const auto& band = multiband.getBand(i);
+        float lowFreq = meters.bandLowFreq[i];
+        float highFreq = meters.bandHighFreq[i];
 
         char label[64];
-        if (band.lowFreq < 1000) {
-            snprintf(label, sizeof(label), "%.0f-%.0fHz", band.lowFreq, band.highFreq);
-        } else if (band.highFreq < 1000) {
-            snprintf(label, sizeof(label), "%.0f-%.0fHz", band.lowFreq, band.highFreq);
+        if (lowFreq < 1000) {
+            snprintf(label, sizeof(label), "%.0f-%.0fHz  GR %.1f dB", lowFreq, highFreq, meters.bandGainReductionDb[i]);
+        } else if (highFreq < 1000) {
+            snprintf(label, sizeof(label), "%.0f-%.0fHz  GR %.1f dB", lowFreq, highFreq, meters.bandGainReductionDb[i]);
         } else {
-            snprintf(label, sizeof(label), "%.1f-%.1fkHz", band.lowFreq/1000, band.highFreq/1000);
+            snprintf(label, sizeof(label), "%.1f-%.1fkHz  GR %.1f dB", lowFreq/1000, highFreq/1000, meters.bandGainReductionDb[i]);
         }
 
-        float energy = band.energy * 100.0f;  // Scale for display
+        float energy = meters.bandEnergy[i] * 100.0f;  // Scale for display
         ImGui::ProgressBar(energy, ImVec2(-1, 0), label);
 
         if ((i + 1) % 2 == 0 && i + 1 < numBands) {
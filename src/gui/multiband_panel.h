@@ -1,15 +1,15 @@
 #pragma once
 #include "common/params.h"
-#include "dsp/dsp_chain.h"
+#include "audio/audio_engine.h"
 
 class MultibandPanel {
 public:
     MultibandPanel() = default;
 
-    void init(SharedParams& params, DSPChain& dsp);
+    void init(SharedParams& params, const AudioEngine& engine);
     void render();
 
 private:
     SharedParams* params_ = nullptr;
-    DSPChain* dsp_ = nullptr;
+    const AudioEngine* engine_ = nullptr;
 };
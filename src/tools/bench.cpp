@@ -0,0 +1,213 @@
+// Chain benchmark: times DSPChain::process on synthetic program material and
+// on the silence that follows it, with flush-to-zero on and off. Once filter,
+// envelope and reverb state decays into subnormals the silent blocks get
+// slower unless denormals are flushed; with FTZ/DAZ on, silence should cost
+// no more than music. --isa compares the dispatched kernel builds.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "dsp/cpu_dispatch.h"
+#include "dsp/dsp_chain.h"
+#include "dsp/float_guard.h"
+#include "common/params.h"
+#include "common/config_loader.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr float SAMPLE_RATE = 48000.0f;
+
+struct Options {
+    std::string configPath = "config.json";
+    int blockSize = 0;
+    double seconds = 10.0;
+    bool allStages = false;
+    std::vector<dsp::Isa> isas;   // empty: whatever is active
+};
+
+struct Timing {
+    double programUs = 0.0;   // mean per block
+    double silenceUs = 0.0;
+};
+
+void printUsage(const char* argv0) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  -c, --config PATH   preset to apply (default: config.json)\n"
+        "      --block FRAMES  processing block size (default: audio.blockSize)\n"
+        "      --seconds SEC   length of each of the program and silence runs (default: 10)\n"
+        "      --all           enable every stage regardless of the preset\n"
+        "      --isa NAME      kernels to time: scalar, sse2, avx2, avx512, neon or all\n"
+        "                      supported ones (default: best supported)\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        const char* value = nullptr;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (arg == "-c" || arg == "--config") {
+            if (!(value = next())) return false;
+            opt.configPath = value;
+        } else if (arg == "--block") {
+            if (!(value = next())) return false;
+            opt.blockSize = std::atoi(value);
+        } else if (arg == "--seconds") {
+            if (!(value = next())) return false;
+            opt.seconds = std::max(0.5, std::atof(value));
+        } else if (arg == "--all") {
+            opt.allStages = true;
+        } else if (arg == "--isa") {
+            if (!(value = next())) return false;
+            dsp::Isa isa;
+            if (std::string(value) == "all") {
+                for (dsp::Isa candidate : { dsp::Isa::Scalar, dsp::Isa::SSE2, dsp::Isa::AVX2,
+                                            dsp::Isa::AVX512, dsp::Isa::NEON }) {
+                    if (dsp::isaSupported(candidate)) opt.isas.push_back(candidate);
+                }
+            } else if (!dsp::parseIsa(value, isa)) {
+                std::fprintf(stderr, "Unknown instruction set '%s'\n", value);
+                return false;
+            } else if (!dsp::isaSupported(isa)) {
+                std::fprintf(stderr, "%s kernels are not available on this machine\n", dsp::isaName(isa));
+                return false;
+            } else {
+                opt.isas.push_back(isa);
+            }
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Two detuned chords with a slow tremolo over low-level noise: broadband
+// enough to keep every band and the compressors busy.
+void fillProgram(std::vector<float>& buffer, int numFrames, uint64_t& frameIndex, uint32_t& noiseState) {
+    static const float freqs[] = { 55.0f, 110.5f, 220.0f, 329.6f, 440.0f, 659.3f, 1318.5f, 2637.0f, 5274.0f };
+    for (int i = 0; i < numFrames; i++) {
+        double t = (double)(frameIndex + i) / SAMPLE_RATE;
+        float tone = 0.0f;
+        for (float f : freqs)
+            tone += (float)std::sin(2.0 * 3.14159265358979323846 * f * t);
+        float tremolo = 0.6f + 0.4f * (float)std::sin(2.0 * 3.14159265358979323846 * 0.5 * t);
+        for (int ch = 0; ch < 2; ch++) {
+            noiseState = noiseState * 1664525u + 1013904223u;
+            float noise = ((noiseState >> 8) / 8388608.0f - 1.0f) * 0.05f;
+            buffer[(size_t)i * 2 + ch] = 0.06f * tremolo * tone + noise;
+        }
+    }
+    frameIndex += numFrames;
+}
+
+Timing runOnce(const AppConfig& appConfig, const Options& opt, int blockSize, bool flushDenormals) {
+    SharedParams params;
+    params.loadFromConfig(appConfig);
+    if (opt.allStages) {
+        params.compressor.enabled.store(true, std::memory_order_relaxed);
+        params.reverb.enabled.store(true, std::memory_order_relaxed);
+        params.crossover.enabled.store(true, std::memory_order_relaxed);
+        params.bandLimiter.enabled.store(true, std::memory_order_relaxed);
+        params.multiband.enabled.store(true, std::memory_order_relaxed);
+        params.publish();
+    }
+
+    DSPChain chain(params);
+    chain.setBackgroundAnalysis(false);
+    chain.prepare(SAMPLE_RATE, blockSize, 2);
+
+    std::vector<float> buffer((size_t)blockSize * 2, 0.0f);
+    chain.process(buffer.data(), blockSize, 2, SAMPLE_RATE);
+    chain.waitForDesigns();
+
+    int numBlocks = (int)(opt.seconds * SAMPLE_RATE / blockSize);
+    uint64_t frameIndex = 0;
+    uint32_t noiseState = 1;
+    Timing timing;
+
+    auto run = [&](bool program) {
+        double totalNs = 0.0;
+        for (int b = 0; b < numBlocks; b++) {
+            if (program)
+                fillProgram(buffer, blockSize, frameIndex, noiseState);
+            else
+                std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+            auto t0 = std::chrono::steady_clock::now();
+            if (flushDenormals) {
+                dsp::ScopedFlushDenormals noDenormals;
+                chain.process(buffer.data(), blockSize, 2, SAMPLE_RATE);
+            } else {
+                chain.process(buffer.data(), blockSize, 2, SAMPLE_RATE);
+            }
+            totalNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+        }
+        return totalNs / 1000.0 / std::max(1, numBlocks);
+    };
+
+    timing.programUs = run(true);
+    // Straight after the program, so every tail decays through the
+    // subnormal range during the run
+    timing.silenceUs = run(false);
+    return timing;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::error_code ec;
+    if (!fs::is_regular_file(opt.configPath, ec))
+        std::fprintf(stderr, "Warning: %s not found, benchmarking with defaults\n", opt.configPath.c_str());
+    AppConfig appConfig = config::loadConfig(opt.configPath);
+
+    int blockSize = opt.blockSize > 0 ? std::min(std::max(opt.blockSize, 16), 16384)
+                                      : std::max(16, appConfig.audio.blockSize);
+    double blockPeriodUs = blockSize * 1e6 / SAMPLE_RATE;
+
+    if (opt.isas.empty())
+        opt.isas.push_back(dsp::activeIsa());
+
+    std::printf("%d-frame blocks at %.0f Hz, %.1f s per run\n", blockSize, SAMPLE_RATE, opt.seconds);
+    for (dsp::Isa isa : opt.isas) {
+        dsp::setIsa(isa);
+        std::printf("\n%s kernels\n", dsp::isaName(isa));
+        std::printf("%-12s %16s %16s %10s\n", "", "program", "silence", "ratio");
+        for (bool flush : { true, false }) {
+            Timing t = runOnce(appConfig, opt, blockSize, flush);
+            std::printf("%-12s %8.1f us %3.0f%% %8.1f us %3.0f%% %9.2fx\n",
+                        flush ? "FTZ/DAZ on" : "FTZ/DAZ off",
+                        t.programUs, 100.0 * t.programUs / blockPeriodUs,
+                        t.silenceUs, 100.0 * t.silenceUs / blockPeriodUs,
+                        t.programUs > 0.0 ? t.silenceUs / t.programUs : 0.0);
+        }
+    }
+    return 0;
+}
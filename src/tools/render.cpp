@@ -0,0 +1,343 @@
+// Offline renderer: streams WAV files through the DSP chain as fast as the
+// CPU allows. A directory is spread over worker threads, each with its own
+// SharedParams/DSPChain pair.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsp/cpu_dispatch.h"
+#include "dsp/dsp_chain.h"
+#include "dsp/float_guard.h"
+#include "common/params.h"
+#include "common/config_loader.h"
+#include "wav_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string configPath = "config.json";
+    std::string input;
+    std::string output;
+    int jobs = 0;
+    int blockSize = 0;
+    double tailSec = 0.0;
+    WavWriter::Format format = WavWriter::Format::Float32;
+};
+
+struct Job {
+    fs::path input;
+    fs::path output;
+};
+
+struct FileResult {
+    bool ok = false;
+    double audioSec = 0.0;
+};
+
+std::mutex g_printMutex;
+
+void printUsage(const char* argv0) {
+    std::printf(
+        "Usage: %s [options] INPUT\n"
+        "  INPUT is a .wav file or a directory of them.\n"
+        "  -c, --config PATH   preset to apply (default: config.json)\n"
+        "  -o, --output PATH   output file or directory\n"
+        "                      (default: INPUT_eq.wav, or INPUT/rendered for a directory)\n"
+        "  -j, --jobs N        files rendered in parallel (default: all cores)\n"
+        "      --block FRAMES  processing block size (default: audio.blockSize)\n"
+        "      --tail SEC      silence appended to let reverb ring out (default: 0)\n"
+        "      --isa NAME      DSP kernels: scalar, sse2, avx2, avx512 or neon (default: best supported)\n"
+        "  -f, --format FMT    f32, s16 or s24 (default: f32)\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        const char* value = nullptr;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (arg == "-c" || arg == "--config") {
+            if (!(value = next())) return false;
+            opt.configPath = value;
+        } else if (arg == "-o" || arg == "--output") {
+            if (!(value = next())) return false;
+            opt.output = value;
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (!(value = next())) return false;
+            opt.jobs = std::atoi(value);
+        } else if (arg == "--block") {
+            if (!(value = next())) return false;
+            opt.blockSize = std::atoi(value);
+        } else if (arg == "--tail") {
+            if (!(value = next())) return false;
+            opt.tailSec = std::max(0.0, std::atof(value));
+        } else if (arg == "--isa") {
+            if (!(value = next())) return false;
+            dsp::Isa isa;
+            if (!dsp::parseIsa(value, isa)) {
+                std::fprintf(stderr, "Unknown instruction set '%s'\n", value);
+                return false;
+            }
+            if (!dsp::setIsa(isa)) {
+                std::fprintf(stderr, "%s kernels are not available on this machine\n", dsp::isaName(isa));
+                return false;
+            }
+        } else if (arg == "-f" || arg == "--format") {
+            if (!(value = next())) return false;
+            std::string fmt = value;
+            if (fmt == "f32")      opt.format = WavWriter::Format::Float32;
+            else if (fmt == "s16") opt.format = WavWriter::Format::Pcm16;
+            else if (fmt == "s24") opt.format = WavWriter::Format::Pcm24;
+            else {
+                std::fprintf(stderr, "Unknown format '%s'\n", value);
+                return false;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return false;
+        } else if (opt.input.empty()) {
+            opt.input = arg;
+        } else {
+            std::fprintf(stderr, "Only one INPUT may be given\n");
+            return false;
+        }
+    }
+    if (opt.input.empty()) {
+        std::fprintf(stderr, "No INPUT given\n");
+        return false;
+    }
+    return true;
+}
+
+bool isWavFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return ext == ".wav";
+}
+
+bool collectJobs(const Options& opt, std::vector<Job>& jobs) {
+    std::error_code ec;
+    fs::path input(opt.input);
+
+    if (fs::is_directory(input, ec)) {
+        fs::path outDir = opt.output.empty() ? input / "rendered" : fs::path(opt.output);
+        fs::create_directories(outDir, ec);
+        if (ec) {
+            std::fprintf(stderr, "Cannot create %s: %s\n", outDir.string().c_str(), ec.message().c_str());
+            return false;
+        }
+        for (const fs::directory_entry& entry : fs::directory_iterator(input, ec)) {
+            if (entry.is_regular_file() && isWavFile(entry.path()))
+                jobs.push_back({ entry.path(), outDir / entry.path().filename() });
+        }
+        // Largest first so one long track does not finish alone at the end
+        std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+            std::error_code e;
+            return fs::file_size(a.input, e) > fs::file_size(b.input, e);
+        });
+    } else if (fs::is_regular_file(input, ec)) {
+        fs::path out = opt.output;
+        if (out.empty())
+            out = input.parent_path() / (input.stem().string() + "_eq.wav");
+        else if (fs::is_directory(out, ec))
+            out /= input.filename();
+        jobs.push_back({ input, out });
+    } else {
+        std::fprintf(stderr, "%s: no such file or directory\n", opt.input.c_str());
+        return false;
+    }
+    return true;
+}
+
+class Renderer {
+public:
+    Renderer(const AppConfig& appConfig, const Options& opt) : opt_(opt), chain_(initParams(appConfig)) {
+        chain_.setBackgroundAnalysis(false);
+        blockSize_ = opt.blockSize > 0 ? std::min(std::max(opt.blockSize, 64), 16384)
+                                       : params_.blockSize.load(std::memory_order_relaxed);
+        buffer_.resize((size_t)blockSize_ * 2);
+        input_.resize((size_t)blockSize_ * 2);
+        output_.resize((size_t)blockSize_ * 2);
+    }
+
+    FileResult render(const Job& job, std::string& error) {
+        FileResult result;
+        WavReader reader;
+        if (!reader.open(job.input.string(), error)) return result;
+        int channels = reader.getChannels();
+        if (channels > 2) {
+            error = "only mono and stereo files are supported";
+            return result;
+        }
+        float sampleRate = (float)reader.getSampleRate();
+
+        WavWriter writer;
+        if (!writer.open(job.output.string(), reader.getSampleRate(), channels, opt_.format, error))
+            return result;
+
+        // The chain always runs in stereo; mono is duplicated in and
+        // averaged back out.
+        chain_.prepare(sampleRate, blockSize_, 2);
+        prime(sampleRate);
+
+        int latency = chain_.getLatencySamples();
+        uint64_t skip = (uint64_t)latency;
+        uint64_t flush = (uint64_t)latency + (uint64_t)(opt_.tailSec * sampleRate);
+
+        for (;;) {
+            int frames = (int)reader.read(input_.data(), (size_t)blockSize_);
+            if (frames < blockSize_ && flush > 0) {
+                // Past the end of the input: zeros to push out delayed audio
+                int pad = (int)std::min<uint64_t>((uint64_t)(blockSize_ - frames), flush);
+                std::fill(input_.begin() + (size_t)frames * channels,
+                          input_.begin() + (size_t)(frames + pad) * channels, 0.0f);
+                flush -= pad;
+                frames += pad;
+            }
+            if (frames == 0) break;
+
+            for (int i = 0; i < frames; i++) {
+                float l = input_[(size_t)i * channels];
+                float r = channels > 1 ? input_[(size_t)i * channels + 1] : l;
+                buffer_[2 * i] = l;
+                buffer_[2 * i + 1] = r;
+            }
+            chain_.process(buffer_.data(), frames, 2, sampleRate);
+
+            int start = (int)std::min<uint64_t>(skip, (uint64_t)frames);
+            skip -= start;
+            int count = frames - start;
+            if (count == 0) continue;
+
+            const float* out = buffer_.data() + (size_t)start * 2;
+            if (channels == 1) {
+                for (int i = 0; i < count; i++)
+                    output_[i] = 0.5f * (out[2 * i] + out[2 * i + 1]);
+                out = output_.data();
+            }
+            if (!writer.write(out, (size_t)count)) {
+                error = "write failed";
+                return result;
+            }
+        }
+
+        if (!writer.close()) {
+            error = "write failed";
+            return result;
+        }
+        result.ok = true;
+        result.audioSec = reader.getFrameCount() / (double)sampleRate;
+        return result;
+    }
+
+private:
+    SharedParams& initParams(const AppConfig& appConfig) {
+        params_.loadFromConfig(appConfig);
+        return params_;
+    }
+
+    // One block of silence pushes the parameters into every stage; the chain
+    // then waits for background-designed filters (linear-phase EQ) so every
+    // file renders the same no matter how the designer thread is scheduled.
+    void prime(float sampleRate) {
+        std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+        chain_.process(buffer_.data(), blockSize_, 2, sampleRate);
+        chain_.waitForDesigns();
+    }
+
+    const Options& opt_;
+    SharedParams params_;
+    DSPChain chain_;
+    int blockSize_ = 1024;
+    std::vector<float> buffer_;
+    std::vector<float> input_;
+    std::vector<float> output_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::error_code ec;
+    if (!fs::is_regular_file(opt.configPath, ec))
+        std::fprintf(stderr, "Warning: %s not found, rendering with defaults\n", opt.configPath.c_str());
+    AppConfig appConfig = config::loadConfig(opt.configPath);
+
+    std::vector<Job> jobs;
+    if (!collectJobs(opt, jobs)) return 1;
+    if (jobs.empty()) {
+        std::fprintf(stderr, "No .wav files in %s\n", opt.input.c_str());
+        return 1;
+    }
+
+    int numWorkers = opt.jobs > 0 ? opt.jobs : (int)std::max(1u, std::thread::hardware_concurrency());
+    numWorkers = std::min(numWorkers, (int)jobs.size());
+
+    std::atomic<size_t> nextJob{0};
+    std::atomic<int> failures{0};
+    std::atomic<uint64_t> audioMs{0};
+
+    auto worker = [&]() {
+        dsp::ScopedFlushDenormals noDenormals;
+        Renderer renderer(appConfig, opt);
+        for (size_t i = nextJob.fetch_add(1); i < jobs.size(); i = nextJob.fetch_add(1)) {
+            const Job& job = jobs[i];
+            auto t0 = std::chrono::steady_clock::now();
+            std::string error;
+            FileResult result = renderer.render(job, error);
+            double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            std::lock_guard<std::mutex> lock(g_printMutex);
+            if (result.ok) {
+                audioMs.fetch_add((uint64_t)(result.audioSec * 1000.0));
+                std::printf("%s -> %s  (%.1f s, %.0fx real time)\n", job.input.string().c_str(),
+                            job.output.string().c_str(), result.audioSec,
+                            wallSec > 0.0 ? result.audioSec / wallSec : 0.0);
+            } else {
+                failures.fetch_add(1);
+                std::fprintf(stderr, "%s: %s\n", job.input.string().c_str(), error.c_str());
+            }
+            std::fflush(stdout);
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int w = 1; w < numWorkers; w++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& t : workers) t.join();
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double totalAudioSec = audioMs.load() / 1000.0;
+    std::printf("%zu file(s), %d failed, %.1f s of audio in %.2f s on %d thread(s) (%.0fx real time)\n",
+                jobs.size(), failures.load(), totalAudioSec, wallSec, numWorkers,
+                wallSec > 0.0 ? totalAudioSec / wallSec : 0.0);
+    return failures.load() > 0 ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+#include "wav_file.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+constexpr size_t IO_CHUNK_FRAMES = 4096;
+
+uint16_t readLE16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t readLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void putLE16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+void putLE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+} // namespace
+
+// ---- WavReader ----
+
+bool WavReader::open(const std::string& path, std::string& error) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        error = "cannot open file";
+        return false;
+    }
+
+    uint8_t riff[12];
+    if (std::fread(riff, 1, 12, file_) != 12 ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        close();
+        return false;
+    }
+
+    bool haveFormat = false;
+    uint16_t formatTag = 0;
+    int blockAlign = 0;
+    for (;;) {
+        uint8_t header[8];
+        if (std::fread(header, 1, 8, file_) != 8) {
+            error = haveFormat ? "no data chunk" : "no fmt chunk";
+            close();
+            return false;
+        }
+        uint32_t size = readLE32(header + 4);
+
+        if (std::memcmp(header, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            size_t want = std::min<size_t>(size, sizeof(fmt));
+            if (size < 16 || std::fread(fmt, 1, want, file_) != want) {
+                error = "truncated fmt chunk";
+                close();
+                return false;
+            }
+            formatTag      = readLE16(fmt);
+            channels_      = readLE16(fmt + 2);
+            sampleRate_    = (int)readLE32(fmt + 4);
+            blockAlign     = readLE16(fmt + 12);
+            bitsPerSample_ = readLE16(fmt + 14);
+            if (formatTag == WAVE_FORMAT_EXTENSIBLE && size >= 40)
+                formatTag = readLE16(fmt + 24);  // first two bytes of the sub-format GUID
+            std::fseek(file_, (long)(size - want + (size & 1)), SEEK_CUR);
+            haveFormat = true;
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = "data chunk before fmt chunk";
+                close();
+                return false;
+            }
+            frameCount_ = blockAlign > 0 ? size / (uint32_t)blockAlign : 0;
+            break;
+        } else {
+            std::fseek(file_, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+
+    isFloat_ = formatTag == WAVE_FORMAT_IEEE_FLOAT;
+    bool supported =
+        (formatTag == WAVE_FORMAT_PCM && (bitsPerSample_ == 16 || bitsPerSample_ == 24 || bitsPerSample_ == 32)) ||
+        (isFloat_ && (bitsPerSample_ == 32 || bitsPerSample_ == 64));
+    if (!supported || channels_ <= 0 || sampleRate_ <= 0 || blockAlign != channels_ * bitsPerSample_ / 8) {
+        error = "unsupported sample format (format " + std::to_string(formatTag) + ", " +
+                std::to_string(bitsPerSample_) + " bit)";
+        close();
+        return false;
+    }
+
+    framesLeft_ = frameCount_;
+    return true;
+}
+
+void WavReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    framesLeft_ = 0;
+}
+
+size_t WavReader::read(float* out, size_t numFrames) {
+    if (!file_) return 0;
+
+    int bytesPerSample = bitsPerSample_ / 8;
+    size_t frameBytes = (size_t)channels_ * bytesPerSample;
+    size_t total = 0;
+
+    while (total < numFrames && framesLeft_ > 0) {
+        size_t frames = (size_t)std::min<uint64_t>({ (uint64_t)(numFrames - total), framesLeft_,
+                                                     (uint64_t)IO_CHUNK_FRAMES });
+        raw_.resize(frames * frameBytes);
+        size_t got = std::fread(raw_.data(), frameBytes, frames, file_);
+        if (got == 0) {
+            framesLeft_ = 0;
+            break;
+        }
+
+        size_t samples = got * channels_;
+        float* dst = out + total * channels_;
+        const uint8_t* src = raw_.data();
+        if (isFloat_ && bitsPerSample_ == 32) {
+            std::memcpy(dst, src, samples * sizeof(float));
+        } else if (isFloat_) {
+            for (size_t i = 0; i < samples; i++) {
+                double d;
+                std::memcpy(&d, src + i * 8, sizeof(double));
+                dst[i] = (float)d;
+            }
+        } else if (bitsPerSample_ == 16) {
+            for (size_t i = 0; i < samples; i++)
+                dst[i] = (int16_t)readLE16(src + i * 2) * (1.0f / 32768.0f);
+        } else if (bitsPerSample_ == 24) {
+            for (size_t i = 0; i < samples; i++) {
+                const uint8_t* p = src + i * 3;
+                int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+                dst[i] = v * (1.0f / 8388608.0f);
+            }
+        } else {
+            for (size_t i = 0; i < samples; i++)
+                dst[i] = (float)((int32_t)readLE32(src + i * 4) * (1.0 / 2147483648.0));
+        }
+
+        total += got;
+        framesLeft_ -= got;
+        if (got < frames) {
+            framesLeft_ = 0;
+            break;
+        }
+    }
+    return total;
+}
+
+// ---- WavWriter ----
+
+bool WavWriter::open(const std::string& path, int sampleRate, int channels, Format format, std::string& error) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = "cannot create file";
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    format_ = format;
+    dataBytes_ = 0;
+    failed_ = false;
+    if (!writeHeader()) {
+        error = "write failed";
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::writeHeader() {
+    int bits = format_ == Format::Pcm16 ? 16 : format_ == Format::Pcm24 ? 24 : 32;
+    int blockAlign = channels_ * bits / 8;
+    uint32_t dataSize = (uint32_t)std::min<uint64_t>(dataBytes_, 0xFFFFFFFFu - 36);
+
+    uint8_t h[44];
+    std::memcpy(h, "RIFF", 4);
+    putLE32(h + 4, 36 + dataSize + (dataSize & 1));
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    putLE32(h + 16, 16);
+    putLE16(h + 20, format_ == Format::Float32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    putLE16(h + 22, (uint16_t)channels_);
+    putLE32(h + 24, (uint32_t)sampleRate_);
+    putLE32(h + 28, (uint32_t)(sampleRate_ * blockAlign));
+    putLE16(h + 32, (uint16_t)blockAlign);
+    putLE16(h + 34, (uint16_t)bits);
+    std::memcpy(h + 36, "data", 4);
+    putLE32(h + 40, dataSize);
+    return std::fwrite(h, 1, sizeof(h), file_) == sizeof(h);
+}
+
+bool WavWriter::write(const float* in, size_t numFrames) {
+    if (!file_ || failed_) return false;
+
+    size_t samples = numFrames * channels_;
+    size_t bytes = 0;
+    switch (format_) {
+        case Format::Float32:
+            raw_.resize(samples * 4);
+            std::memcpy(raw_.data(), in, samples * sizeof(float));
+            bytes = samples * 4;
+            break;
+        case Format::Pcm16:
+            raw_.resize(samples * 2);
+            for (size_t i = 0; i < samples; i++) {
+                float x = std::max(-1.0f, std::min(1.0f, in[i]));
+                putLE16(&raw_[i * 2], (uint16_t)(int16_t)std::lrintf(x * 32767.0f));
+            }
+            bytes = samples * 2;
+            break;
+        case Format::Pcm24:
+            raw_.resize(samples * 3);
+            for (size_t i = 0; i < samples; i++) {
+                float x = std::max(-1.0f, std::min(1.0f, in[i]));
+                int32_t v = (int32_t)std::lrintf(x * 8388607.0f);
+                raw_[i * 3]     = (uint8_t)v;
+                raw_[i * 3 + 1] = (uint8_t)(v >> 8);
+                raw_[i * 3 + 2] = (uint8_t)(v >> 16);
+            }
+            bytes = samples * 3;
+            break;
+    }
+
+    if (std::fwrite(raw_.data(), 1, bytes, file_) != bytes) {
+        failed_ = true;
+        return false;
+    }
+    dataBytes_ += bytes;
+    if (dataBytes_ > 0xFFFFFFFFu - 36) failed_ = true;
+    return !failed_;
+}
+
+bool WavWriter::close() {
+    if (!file_) return !failed_;
+
+    if (dataBytes_ & 1) {
+        uint8_t pad = 0;
+        if (std::fwrite(&pad, 1, 1, file_) != 1) failed_ = true;
+    }
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || !writeHeader()) failed_ = true;
+    if (std::fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+    return !failed_;
+}
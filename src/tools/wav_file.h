@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Streaming RIFF/WAVE I/O for the offline tools. Samples are exchanged as
+// interleaved float in [-1, 1]; reading accepts 16/24/32-bit PCM and 32/64-bit
+// float (plain or WAVE_FORMAT_EXTENSIBLE).
+class WavReader {
+public:
+    WavReader() = default;
+    ~WavReader() { close(); }
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    // Returns the number of frames read; fewer than requested only at the end.
+    size_t read(float* out, size_t numFrames);
+
+    int getSampleRate() const { return sampleRate_; }
+    int getChannels() const { return channels_; }
+    int getBitsPerSample() const { return bitsPerSample_; }
+    bool isFloat() const { return isFloat_; }
+    uint64_t getFrameCount() const { return frameCount_; }
+
+private:
+    FILE* file_ = nullptr;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    int bitsPerSample_ = 0;
+    bool isFloat_ = false;
+    uint64_t frameCount_ = 0;
+    uint64_t framesLeft_ = 0;
+    std::vector<uint8_t> raw_;
+};
+
+class WavWriter {
+public:
+    enum class Format {
+        Pcm16,
+        Pcm24,
+        Float32
+    };
+
+    WavWriter() = default;
+    ~WavWriter() { close(); }
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool open(const std::string& path, int sampleRate, int channels, Format format, std::string& error);
+    bool write(const float* in, size_t numFrames);
+    // Patches the chunk sizes into the header; false if any write failed.
+    bool close();
+
+private:
+    bool writeHeader();
+
+    FILE* file_ = nullptr;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    Format format_ = Format::Float32;
+    uint64_t dataBytes_ = 0;
+    bool failed_ = false;
+    std::vector<uint8_t> raw_;
+};